@@ -15,6 +15,7 @@ This file (change_password.c) is responsible for:
 #include "main.h"
 #include "clcd.h"
 #include "ext_eep.h"
+#include "eep_cache.h"
 #include "matrix_keypad.h"
 
 void change_pass(char key) 
@@ -38,7 +39,7 @@ void change_pass(char key)
     } 
     else if (i < 8) 
     {  // Re-enter new password
-        if (i == 4) CLEAR_DISP_SCREEN;
+        if (i == 4) clcd_clear();
         clcd_print("RE-ENTER PASS", LINE1(0));
         if (key == MK_SW11) 
         {
@@ -56,20 +57,24 @@ void change_pass(char key)
     {  // Verify and save
         if (npass == rnpass) 
         {
-            write_ext_eep(200, npass);  // Store password in EEPROM
             clcd_print("CHANGE PASS", LINE1(0));
-            clcd_print("SUCCESSFUL", LINE2(0));
+            if (eep_cache_write(EEP_PASSWORD_ADDR, npass) == I2C_OK &&  // Store password in EEPROM
+                eep_cache_flush() == I2C_OK)                            // Commit it now, not when idle
+                clcd_print("SUCCESSFUL", LINE2(0));
+            else
+                clcd_print("FAILED", LINE2(0));         // EEPROM did not answer, old password kept
         }
         else 
         {
             clcd_print("CHANGE PASS", LINE1(0));
             clcd_print("FAILED", LINE2(0));
         }
+        clcd_flush();  // Show the result before waiting
         __delay_ms(1000);
         i = 0;
         npass = 0;
         rnpass = 0;
-        CLEAR_DISP_SCREEN;
+        clcd_clear();
         main_f = MENU;
     }
 }
@@ -112,7 +117,7 @@ Increments i to track entry progress.
 
 } else if (i < 8) 
  * {  // Re-enter new password
-    if (i == 4) CLEAR_DISP_SCREEN;
+    if (i == 4) clcd_clear();
     clcd_print("RE-ENTER PASS", LINE1(0));
 ? Ensures user re-enters the same password for confirmation.
 
@@ -162,19 +167,19 @@ npass (New Password)	rnpass (Re-entered Password)    	Result
     i = 0;
     npass = 0;
     rnpass = 0;
-    CLEAR_DISP_SCREEN;
+    clcd_clear();
     main_f = MENU;
 }
 ? After password verification:
 
 Waits for 1 second (__delay_ms(1000)).
 Resets all variables (i, npass, rnpass) for future password changes.
-Clears the screen (CLEAR_DISP_SCREEN).
+Clears the screen (clcd_clear()).
 Returns to the menu (main_f = MENU).
 ? Summary of change_password.c
     Function                        Purpose
 change_pass(key)        	Handles password change process
 write_ext_eep(200, npass)	Saves new password in EEPROM
 clcd_putch('*', LINE2(i))	Displays * instead of actual digits for security
-CLEAR_DISP_SCREEN           Clears the LCD before new messages
+clcd_clear()           Clears the LCD before new messages
  */
\ No newline at end of file
@@ -8,43 +8,158 @@
 ? LCD Initialization ? Configures LCD in 8-bit mode.
 ? LCD Commands & Data Writing ? Sends commands and characters to LCD.
 ? Functions for Displaying Text & Characters ? Used in the Dashboard, Menu, and Password Entry screens.
+? Background Writer ? clcd_flush() queues bytes, the Timer2 interrupt sends them one nibble per tick.
+? LCD Timing ? Fixed delays for init, Timer2 ticks for the background writer.
+? Shadow Framebuffer ? clcd_print()/clcd_putch() only update RAM, clcd_flush() sends the cells that changed.
 
  */
 
 #include "clcd.h"
 #include "main.h"
+
+static char clcd_fb[CLCD_ROWS][CLCD_COLS];          // What the screen should show
+static char clcd_shown[CLCD_ROWS][CLCD_COLS];      // What the LCD shows now
+static unsigned char clcd_cursor;                  // DDRAM address the LCD writes to next
+
+#if (_XTAL_FREQ / 1000000UL) * CLCD_TICK_US / 16 > 256
+#error "CLCD_TICK_US too long for Timer2 (prescaler 1:4)"
+#endif
+#define CLCD_PR2  ((_XTAL_FREQ / 1000000UL) * CLCD_TICK_US / 16 - 1)  // Fosc/4, prescaler 1:4
+
+static unsigned char clcd_q_byte[CLCD_QUEUE_LEN];  // Queued bytes
+static unsigned char clcd_q_mode[CLCD_QUEUE_LEN];  // 0 = command, 1 = data
+static volatile unsigned char clcd_q_head;         // Next free entry (main loop)
+static volatile unsigned char clcd_q_tail;         // Entry being sent (ISR)
+static volatile unsigned char clcd_hold;           // Ticks left after clear/home
+static unsigned char clcd_low_next;                // ISR: high nibble sent, low nibble next
+
+// One enable pulse with the upper 4 bits of nibble on the data pins
+static void clcd_nibble(unsigned char nibble) {
+    EN = 1;
+    PORTD = (nibble & 0xF0);
+    EN = 0;
+}
+
 void init_clcd(void) {
     TRISD = 0x00;  // Configure PORTD as output
     __delay_ms(15);  // LCD power-on delay
 
-    clcd_write(0x02, 0);  // Set 4-bit mode
+    T2CON = 0x01;  // Timer2 prescaler 1:4, postscaler 1:1
+    PR2 = CLCD_PR2;  // One interrupt every CLCD_TICK_US
+    TMR2IF = 0;
+    TMR2IE = 0;  // Enabled while the queue holds data
+    TMR2ON = 1;
+
+    clcd_write(RETURN_HOME, 0);  // Set 4-bit mode
     clcd_write(0x28, 0);  // 2-line display, 5x7 font
     clcd_write(DISPLAY_ON_CURSOR_OFF, 0);  // Display ON, Cursor OFF
     clcd_write(CLEAR_DISP_SCREEN, 0);  // Clear screen
-    __delay_ms(2);  // Clear screen delay
+
+    for (unsigned char row = 0; row < CLCD_ROWS; row++) {
+        for (unsigned char col = 0; col < CLCD_COLS; col++)
+            clcd_fb[row][col] = clcd_shown[row][col] = ' ';  // Matches the cleared LCD
+    }
+    clcd_cursor = LINE1(0);  // Clear screen homes the cursor
 }
 
 void clcd_write(unsigned char byte, unsigned char mode) {
+    while (clcd_q_tail != clcd_q_head || clcd_hold);  // Let the background writer finish first
+
     RS = mode;  // RS = 0 for command, RS = 1 for data
     RW = 0;  // RW = 0 for write
-    EN = 1;
-    PORTD = (byte & 0xF0);  // Send higher nibble
-    EN = 0;
-    __delay_us(100);
-    EN = 1;
-    PORTD = ((byte << 4) & 0xF0);  // Send lower nibble
-    EN = 0;
-    __delay_ms(2);
+    clcd_nibble(byte);  // Send higher nibble
+    __delay_us(1);  // Enable cycle time, no busy time between nibbles
+    clcd_nibble(byte << 4);  // Send lower nibble
+
+    if (mode == 0 && byte <= RETURN_HOME + 1)
+        __delay_ms(CLCD_LONG_DELAY_MS);  // Clear and home are the only slow commands
+    else
+        __delay_us(CLCD_DELAY_US);
 }
 
 void clcd_print(const char *str, unsigned char addr) {
-    clcd_write(addr, 0);  // Set cursor position
     while (*str) {
-        clcd_write(*str++, 1);  // Print each character
+        clcd_putch(*str++, addr++);  // Print each character
     }
 }
 
 void clcd_putch(char data, unsigned char addr) {
-    clcd_write(addr, 0);  // Set cursor position
-    clcd_write(data, 1);  // Print character
+    unsigned char row = (addr & 0x40) ? 1 : 0;  // LINE2() addresses have bit 6 set
+    unsigned char col = addr & 0x3F;
+
+    if (col < CLCD_COLS)
+        clcd_fb[row][col] = data;  // Off-screen columns are dropped
+}
+
+void clcd_clear(void) {
+    for (unsigned char row = 0; row < CLCD_ROWS; row++) {
+        for (unsigned char col = 0; col < CLCD_COLS; col++)
+            clcd_fb[row][col] = ' ';
+    }
+}
+
+static unsigned char clcd_queue_free(void) {
+    unsigned char used = clcd_q_head + CLCD_QUEUE_LEN - clcd_q_tail;
+
+    if (used >= CLCD_QUEUE_LEN)
+        used -= CLCD_QUEUE_LEN;
+    return CLCD_QUEUE_LEN - 1 - used;  // One entry stays empty to tell full from empty
+}
+
+static void clcd_enqueue(unsigned char byte, unsigned char mode) {
+    unsigned char head = clcd_q_head;
+
+    clcd_q_byte[head] = byte;
+    clcd_q_mode[head] = mode;
+    if (++head == CLCD_QUEUE_LEN)
+        head = 0;
+    clcd_q_head = head;  // Entry is complete before the ISR can see it
+    TMR2IE = 1;  // Start (or keep) the writer running
+}
+
+void clcd_flush(void) {
+    for (unsigned char row = 0; row < CLCD_ROWS; row++) {
+        unsigned char addr = row ? LINE2(0) : LINE1(0);
+
+        for (unsigned char col = 0; col < CLCD_COLS; col++, addr++) {
+            if (clcd_fb[row][col] == clcd_shown[row][col])
+                continue;  // Cell already right on the LCD
+            if (clcd_queue_free() < (clcd_cursor != addr ? 2 : 1))
+                return;  // Queue full, the rest goes out on the next flush
+            if (clcd_cursor != addr)
+                clcd_enqueue(addr, 0);  // Only at the start of a run, the LCD auto-increments
+            clcd_enqueue(clcd_fb[row][col], 1);
+            clcd_shown[row][col] = clcd_fb[row][col];
+            clcd_cursor = addr + 1;
+        }
+    }
+}
+
+void clcd_tick(void) {
+    unsigned char tail = clcd_q_tail;
+
+    if (clcd_hold) {
+        clcd_hold--;  // Clear/home still running
+        return;
+    }
+    if (tail == clcd_q_head) {
+        TMR2IE = 0;  // Queue empty, stop until the next clcd_flush()
+        return;
+    }
+
+    if (!clcd_low_next) {
+        RS = clcd_q_mode[tail];
+        RW = 0;
+        clcd_nibble(clcd_q_byte[tail]);  // Higher nibble
+        clcd_low_next = 1;
+        return;
+    }
+
+    clcd_nibble(clcd_q_byte[tail] << 4);  // Lower nibble
+    clcd_low_next = 0;
+    if (clcd_q_mode[tail] == 0 && clcd_q_byte[tail] <= RETURN_HOME + 1)
+        clcd_hold = CLCD_LONG_TICKS;
+    if (++tail == CLCD_QUEUE_LEN)
+        tail = 0;
+    clcd_q_tail = tail;
 }
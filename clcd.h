@@ -8,11 +8,25 @@
 #define RW RD3  // Read/Write
 #define EN RD4  // Enable
 
+// LCD timing: per-command delays, the busy flag cannot be read on this wiring (see 5)
+#define CLCD_DELAY_US       50   // Fixed delay after data and most commands (37 us max)
+#define CLCD_LONG_DELAY_MS  2    // Fixed delay after clear/home (1.52 ms max)
+
+// Background writer (Timer2 interrupt)
+#define CLCD_QUEUE_LEN      24   // Queued LCD bytes (command or data)
+#define CLCD_TICK_US        100  // Timer2 period, one nibble per tick
+#define CLCD_LONG_TICKS     (CLCD_LONG_DELAY_MS * 1000 / CLCD_TICK_US)  // Hold after clear/home
+
 // Define LCD Commands
 #define CLEAR_DISP_SCREEN  0x01  // Clear LCD screen
+#define RETURN_HOME        0x02  // Cursor home (0x03 too), also sets 4-bit mode at init
 #define DISPLAY_ON_CURSOR_OFF  0x0C  // Turn ON display, cursor OFF
 #define DISPLAY_ON_CURSOR_ON   0x0E  // Turn ON display, cursor ON
 
+// Screen size (shadow framebuffer in clcd.c)
+#define CLCD_ROWS  2
+#define CLCD_COLS  16
+
 // Define LCD Line Addresses
 #define LINE1(x) (0x80 + x)  // Line 1 Start Address
 #define LINE2(x) (0xC0 + x)  // Line 2 Start Address
@@ -22,6 +36,9 @@ void init_clcd(void);                      // Initialize LCD
 void clcd_write(unsigned char, unsigned char);  // Write command or data
 void clcd_print(const char *, unsigned char);  // Print string on LCD
 void clcd_putch(char, unsigned char);      // Print single character
+void clcd_clear(void);                     // Blank the framebuffer
+void clcd_flush(void);                     // Queue changed cells for the LCD
+void clcd_tick(void);                      // Timer2 ISR: send one queued nibble
 
 #endif
 
@@ -65,10 +82,50 @@ init_clcd() ? Initializes LCD in 8-bit mode, clears display, sets cursor.
 clcd_write(byte, mode) ? Sends commands (mode = 0) or data (mode = 1) to LCD.
 clcd_print(data, addr) ? Displays a string at a given position.
 clcd_putch(data, addr) ? Displays a single character at a given position.
+clcd_clear() ? Blanks the screen.
+clcd_flush() ? Queues only the cells that changed since the last flush.
+clcd_tick() ? Called from the Timer2 interrupt, sends one queued nibble.
+
+? clcd_print(), clcd_putch() and clcd_clear() only write a 2x16 framebuffer
+in RAM (no LCD access). clcd.c keeps a second copy of what the LCD shows,
+and clcd_flush() compares the two and sends just the cells that differ. A cursor address command is sent only at the
+start of a run of changed cells, since the LCD moves the cursor on by itself.
+A screen that is redrawn with the same content costs no LCD writes at all.
  *
+5 LCD Timing
+
+? An HD44780 needs about 37 us for a data write or most commands, and
+1.52 ms only for clear (0x01) and home (0x02/0x03). clcd_write() waits
+CLCD_DELAY_US after each write and CLCD_LONG_DELAY_MS after clear/home
+only, so a data byte costs tens of microseconds instead of the old fixed
+2.1 ms.
+
+? Busy-flag polling is not possible on this board: EN is RD4, which is
+also the LCD's D4 line (clcd_nibble() writes the data nibble to RD4..RD7).
+Reading with RW = 1 would make the LCD drive D4 against EN, so RW stays
+low and the timing comes only from the per-command delays above.
+
+6 Background Writer
+
+? clcd_flush() does not touch the LCD. It puts the changed cells (and a
+cursor address command where a run starts) into a CLCD_QUEUE_LEN entry
+queue and returns at once. Timer2 interrupts every CLCD_TICK_US while the
+queue holds data, and clcd_tick() sends one nibble per interrupt, so a
+byte takes 200 us and a full screen about 7 ms in the background. That is
+well above the 37 us the LCD needs per byte, so the writer does not read
+the busy flag; after clear/home it holds for CLCD_LONG_TICKS ticks.
+
+? If the queue fills up, the remaining cells are left unsent and go out
+on a later clcd_flush(), which always sends the newest content. When the
+queue is empty the Timer2 interrupt is switched off, so an idle display
+costs no CPU time. clcd_write() is still the blocking path, used by
+init_clcd(). It waits for the queue to drain first.
+
 ? Summary of clcd.h
 
 Header Guards           -> Prevents multiple inclusions of the file
 LCD Port Definitions    -> Defines which PIC pins are connected to LCD
 Command Type Macros     -> Specifies command mode vs data mode
+LCD Timing              -> Fixed delays used by clcd_write()
+Background Writer       -> Queue drained by the Timer2 interrupt
 Function Prototypes     -> Declares LCD functions for use in clcd.c & main.c*/
\ No newline at end of file
@@ -15,25 +15,26 @@
 #include "clcd.h"
 #include "ext_eep.h"
 
+// Hides all records and logs a "CL" record (menu and console "clear")
+void clear_log_records(void)
+{
+    char temp = index;
+    index = 9;
+
+    // Start a new log epoch, a single EEPROM page write
+    log_clear();
+
+    save_log();
+    index = temp;
+}
+
 void clear_log(char key) 
 {
     clcd_print("CLEAR LOG", LINE1(0));
 
     if (wait1 == 1000) 
     {  // Prevents accidental multiple clears
-        char temp = index;
-        index = 9;
-        over_flow = 0;
-        val = 0;
-
-        // Erase stored logs in EEPROM
-        for (unsigned char i = 0; i < 50; i++) 
-        {
-            write_ext_eep(i, 0xFF);  // Set all log locations to 0xFF (erased)
-        }
-
-        save_log();
-        index = temp;
+        clear_log_records();
     }
 
     clcd_print("LOG CLEARED", LINE2(0));
@@ -42,7 +43,7 @@ void clear_log(char key)
     if (--wait1 == 0) {
         wait1 = 1000;
         main_f = MENU;
-        CLEAR_DISP_SCREEN;
+        clcd_clear();
     }
 }
 
@@ -72,34 +73,24 @@ Prevents accidental multiple deletions if the function is triggered twice quickl
 
 char temp = index;
 index = 9;
-over_flow = 0;
-val = 0;
 ? Temporarily stores index before clearing logs.
 
 index = 9; ? Assigns a fixed index to identify log clearing.
-over_flow = 0; ? Resets overflow tracking, preventing old logs from being read.
-val = 0; ? Resets the log counter.
 4?? Erase Stored Logs from EEPROM
 
-for (unsigned char i = 0; i < 50; i++) {
-    write_ext_eep(i, 0xFF);  // Set all log locations to 0xFF (erased)
-}
-? Deletes all stored logs in EEPROM.
+log_clear();
+? Hides all stored logs in EEPROM.
 
-Loops through the first 50 memory addresses (EEPROM log storage).
-Writes 0xFF to each address to mark them as erased.
+Nothing is erased: log_clear() stores a new epoch (the sequence number of
+the next record) in the config area with one page write. Records from
+older epochs are no longer shown by view_log() or download_log(), and
+their slots are reused as new records are written.
 ? EEPROM Before Clearing:
 
-Address	Stored Log
-0x00	0x45 (Event Data)
-0x01	0x32 (Time Data)
-0x02	0xA1 (Speed Data)
+Config	Epoch = 0      (records 0..41 visible)
 ? EEPROM After Clearing:
 
-Address	Stored Log
-0x00	0xFF (Erased)
-0x01	0xFF (Erased)
-0x02	0xFF (Erased)
+Config	Epoch = 42     (records 0..41 hidden, slots reused later)
 5?? Save Changes & Restore Index
 
 save_log();
@@ -125,7 +116,7 @@ LOG CLEARED
 if (--wait1 == 0) {
     wait1 = 1000;
     main_f = MENU;
-    CLEAR_DISP_SCREEN;
+    clcd_clear();
 }
 ? Prevents immediate return to the menu to allow the user to see the confirmation.
 
@@ -133,8 +124,9 @@ Waits before switching back to MENU.
 Clears the screen to remove the message before returning.
 ? Summary of clear_log.c
     Function                                      Purpose
-clear_log(key)                              Erases all logs stored in EEPROM
-write_ext_eep(i, 0xFF)                      Writes 0xFF to each EEPROM address to mark it as erased
+clear_log(key)                              Clears all logs stored in EEPROM
+clear_log_records()                         Clears and logs "CL", also used by the UART console
+log_clear()                                 Starts a new log epoch (one page write)
 clcd_print("LOG CLEARED", LINE2(0))     	Displays success message after clearing logs
 save_log()                                  Saves the cleared log state in EEPROM
 */
@@ -0,0 +1,209 @@
+/*
+ * File:   console.c
+
+ ? Step 41: Setting Up console.c (UART Command Console)
+This file (console.c) is responsible for:
+? Collecting received UART bytes into a command line without ever waiting for input.
+? Running the commands dump, dump since, clear, settime, stats, baud and stream.
+? Starting binary downloads when the host asks for them.
+ */
+
+#include <xc.h>
+#include <string.h>
+#include "main.h"
+#include "console.h"
+
+// Line states
+#define CON_TEXT  0   // Collecting a command line
+#define CON_HOST  1   // DL_CMD_SINCE received, host number comes next
+#define CON_SKIP  2   // Line too long, dropped up to its end
+
+static char con_line[CON_LINE_MAX + 1];
+static unsigned char con_len;
+static unsigned char con_state = CON_TEXT;
+
+// Argument of a "<cmd> <arg>" line, 0 if the line holds another command
+static const char *argument(const char *cmd)
+{
+    unsigned char len = strlen(cmd);
+
+    if (strncmp(con_line, cmd, len) != 0 || con_line[len] != ' ')
+        return 0;
+    return con_line + len + 1;
+}
+
+// Decimal number filling the rest of the line, 0 if there is none
+static unsigned char parse_dec(const char *s, unsigned long *value)
+{
+    if (*s < '0' || *s > '9')
+        return 0;
+    *value = 0;
+    while (*s >= '0' && *s <= '9')
+    {
+        *value = *value * 10 + (*s++ - '0');
+    }
+    return *s == '\0';
+}
+
+// Two decimal digits up to max, converted to BCD for the DS1307
+static unsigned char parse_bcd(const char *s, unsigned char max, unsigned char *bcd)
+{
+    if (s[0] < '0' || s[0] > '9' || s[1] < '0' || s[1] > '9')
+        return 0;
+    if ((s[0] - '0') * 10 + (s[1] - '0') > max)
+        return 0;
+    *bcd = ((s[0] - '0') << 4) | (s[1] - '0');
+    return 1;
+}
+
+static unsigned char set_time(const char *s)
+{
+    unsigned char hours, minutes, seconds;
+
+    if (strlen(s) != 8 || s[2] != ':' || s[5] != ':')
+        return 0;
+    if (!parse_bcd(s, 23, &hours) || !parse_bcd(s + 3, 59, &minutes) || !parse_bcd(s + 6, 59, &seconds))
+        return 0;
+    return rtc_set_time(hours, minutes, seconds) == I2C_OK;
+}
+
+// Runs the command in con_line; dump and stats answer through download_task()
+static void run_line(void)
+{
+    const char *arg;
+    unsigned long value;
+
+    if (strcmp(con_line, "dump") == 0)
+        download_ascii(0);
+    else if ((arg = argument("dump since")) && parse_dec(arg, &value))
+        download_ascii(value);
+    else if (strcmp(con_line, "stats") == 0)
+        download_stats();
+    else if (strcmp(con_line, "clear") == 0)
+    {
+        clear_log_records();
+        puts("OK\n\r");
+    }
+    else if ((arg = argument("settime")) && set_time(arg))
+        puts("OK\n\r");
+    else if (strcmp(con_line, "stream off") == 0)
+    {
+        telemetry_stop();
+        puts("OK\n\r");
+    }
+    else if ((arg = argument("stream")) && parse_dec(arg, &value) && value <= TM_RATE_MAX
+             && telemetry_start(value))
+        puts("OK\n\r");       // Telemetry frames follow (telemetry.h)
+    else if ((arg = argument("baud")) && parse_dec(arg, &value) && uart_baud_ok(value))
+    {
+        puts("OK\n\r");         // Still at the old rate
+        uart_set_baud(value);   // Waits only for these few bytes to leave
+    }
+    else
+        puts("ERR\n\r");
+}
+
+void console_task(void)
+{
+    unsigned char byte;
+
+    // Bytes received during a download are its ACK/NAK, leave them to download_task()
+    while (!download_busy() && uart_tx_free() >= CON_REPLY_MAX && uart_read(&byte))
+    {
+        if (con_state == CON_HOST)
+        {
+            con_state = CON_TEXT;
+            if (byte < DL_HOSTS)
+                download_binary(byte);  // Records this host has not ACKed yet
+            else
+                puts("ERR\n\r");
+            return;
+        }
+
+        if (byte == '\r' || byte == '\n')
+        {
+            if (con_state == CON_SKIP)
+            {
+                con_state = CON_TEXT;
+                puts("ERR\n\r");
+            }
+            else if (con_len == 0)
+                continue;               // Empty line, or LF after CR
+            else
+            {
+                con_line[con_len] = '\0';
+                run_line();
+            }
+            con_len = 0;
+            return;                     // One command per main loop pass
+        }
+
+        if (con_state == CON_SKIP)
+            continue;
+        if (con_len == 0 && byte == DL_CMD_BINARY)
+        {
+            download_binary(DL_NO_HOST);  // Whole log, binary frames
+            return;
+        }
+        if (con_len == 0 && byte == DL_CMD_SINCE)
+        {
+            con_state = CON_HOST;
+            continue;
+        }
+        if (byte == '\b' || byte == 0x7F)
+        {
+            if (con_len)
+                con_len--;              // Backspace/DEL from a terminal
+        }
+        else if (con_len == CON_LINE_MAX)
+            con_state = CON_SKIP;
+        else
+            con_line[con_len++] = byte;
+    }
+}
+
+/*
+ 1 - console_task() - Non-Blocking Line Parser
+
+? Called once per main loop pass. It only takes bytes that are already in
+the UART RX ring (filled by uart_isr()), so the keypad, the LCD and event
+logging never wait for the host. Bytes of a line that is not complete yet
+stay in con_line[] until the next pass.
+
+? At most one command runs per call, and only when the TX ring has room for
+a short reply. dump and stats only start the download state machine;
+download_task() sends the lines as the TX ring drains.
+
+? While download_busy() is 1 the console does not read the RX ring: the
+binary download reads its ACK/NAK bytes from it, and a command typed
+during an ASCII dump simply waits in the ring (UART_RX_LEN bytes).
+
+2 - Example Session (host lines marked >)
+
+> stats
+LOG 42 FIRST 0
+EEPROM ERR 0 RETRY 0 TIMEOUT 0
+DS1307 ERR 0 RETRY 0 TIMEOUT 0
+> dump since 40
+Logs from 40:
+#  TIME  EVENT SPEED
+0 12:30:45 GR 40
+1 12:35:22 G2 55
+...
+> settime 07:15:00
+OK
+> stream 20
+OK
+(20 telemetry frames per second follow, binary)
+> baud 115200
+OK
+
+? clear and settime use the same blocking EEPROM/I2C calls as the keypad
+menu, a few milliseconds each.
+
+? Summary of console.c
+    Function                     Purpose
+console_task()          Collects a command line from the RX ring and runs it
+run_line()              Dispatches dump, dump since, stats, clear, settime, baud, stream
+set_time(arg)           Checks HH:MM:SS and sets the RTC (rtc_set_time())
+ */
@@ -0,0 +1,45 @@
+/*
+ ? Step 40: Setting Up console.h (UART Command Console Header File)
+This file (console.h) is needed to:
+? Define the size of the command line buffer and the console replies.
+? Declare the console task called from the main loop.
+? Let a host script pull logs without anyone touching the keypad.
+*/
+
+#ifndef CONSOLE_H
+#define CONSOLE_H
+
+#define CON_LINE_MAX   24   // Longest command line: "dump since 4294967295" + margin
+#define CON_REPLY_MAX  8    // TX ring space needed before a line is run ("ERR\n\r")
+
+// Function Prototypes
+void console_task(void);   // Main loop: take received bytes, run a complete command line
+
+#endif
+
+/*
+ 1 - Commands (one per line, ended by CR or LF)
+
+Command			Reply
+dump			ASCII dump of the whole log (download_log.c)
+dump since <seq>	ASCII dump from sequence number <seq> on
+clear			Clears the log like the CLEAR LOG menu, then OK
+settime HH:MM:SS	Sets the DS1307 and the software clock, then OK
+stats			LOG / EEPROM / DS1307 counter lines
+baud <rate>		OK at the old rate, then switches (9600 ... 115200)
+stream <hz>		OK, then binary telemetry frames at hz (1 ... 50, telemetry.h)
+stream off		Stops the telemetry stream, then OK
+
+? An unknown command, a bad argument or a line longer than CON_LINE_MAX
+gets ERR. Backspace removes the last character, so the console also works
+from a terminal (there is no echo).
+
+? DL_CMD_BINARY and DL_CMD_SINCE + host number (download_log.h) at the
+start of a line start a binary download right away, without a line end.
+
+2 - Function Prototypes (Used in console.c)
+
+console_task()  ? Called once per main loop pass. Takes bytes from the UART RX
+                  ring and runs at most one command per call. While a download
+                  is running it leaves the RX ring alone (ACK/NAK bytes).
+*/
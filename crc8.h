@@ -0,0 +1,38 @@
+/*
+ ? Step 33: Setting Up crc8.h (CRC-8 Header File)
+This file (crc8.h) is needed to:
+? Declare the CRC-8 routine used to protect log records and UART frames.
+? Share one CRC definition between the firmware and host tools.
+
+This header does not include <xc.h> so it can also be used by host tools.
+*/
+
+#ifndef CRC8_H
+#define CRC8_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define CRC8_INIT  0x00   // Initial CRC value
+
+// Function Prototypes
+unsigned char crc8(unsigned char crc, const unsigned char *buf, unsigned char len);  // Update CRC over buf
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
+
+/*
+ 1 - CRC-8 Parameters
+
+Polynomial 0x07 (x^8 + x^2 + x + 1), initial value 0x00, no reflection,
+no final XOR. Check value: crc8(CRC8_INIT, "123456789", 9) = 0xF4.
+
+? Example Usage:
+
+unsigned char crc = crc8(CRC8_INIT, rec, 4);      // CRC of one record
+crc = crc8(crc, more, 2);                          // Continue over more bytes
+*/
@@ -17,7 +17,7 @@ This file (dashboard.c) is responsible for:
 
 void display_dashboard(void) 
 {
-    CLEAR_DISP_SCREEN;  // Clear LCD screen
+    clcd_clear();  // Clear LCD screen
     clcd_print("TIME  SPD  GEAR", LINE1(0));  // Display header
     update_dashboard();  // Show initial values
 }
@@ -57,13 +57,13 @@ It ensures continuous updates of speed, time, and gear status.
 
 void display_dashboard(void) 
 {
-    CLEAR_DISP_SCREEN;  // Clear LCD screen
+    clcd_clear();  // Clear LCD screen
     clcd_print("TIME  SPD  GEAR", LINE1(0));  // Display header
     update_dashboard();  // Show initial values
 }
 ? This function initializes the dashboard screen.
 
-CLEAR_DISP_SCREEN; ? Clears the LCD to remove old data.
+clcd_clear(); ? Clears the LCD to remove old data.
 clcd_print("TIME SPD GEAR", LINE1(0)); ? Displays column labels for:
 Time (HH:MM:SS)
 Speed (SPD - Vehicle Speed)
@@ -8,6 +8,8 @@
 This file (download_log.c) is responsible for:
 ? Transferring stored logs from EEPROM to a PC via UART.
 ? Sending log data in a structured format (Time, Event, Speed).
+? Sending log data as CRC-protected binary frames when the host asks for it.
+? Remembering per host how far it has downloaded, so a pull sends only new records.
 ? Displaying "Downloading..." on the LCD during data transfer.
  */
 
@@ -17,61 +19,419 @@ This file (download_log.c) is responsible for:
 #include "clcd.h"
 #include "ext_eep.h"
 #include "uart.h"
+#include "download_log.h"
 
-void download_log() 
+static void put_dec(unsigned long n)
 {
-    if (o == 0) 
+    char digits[10];
+    unsigned char len = 0;
+
+    do
     {
-        CLEAR_DISP_SCREEN;
-        clcd_print("Downloading...", LINE1(0));
+        digits[len++] = n % 10 + '0';
+        n /= 10;
+    } while (n);
+    while (len)
+        putch(digits[--len]);  // Most significant digit first
+}
 
-        init_uart();
-        puts("Logs:\n\r");
-        puts("#  TIME  EVENT SPEED\n\r");
+static void put_i2c_stats(const char *name, unsigned char dev)
+{
+    puts(name);
+    puts(" ERR ");
+    put_dec(i2c_stats[dev].errors);
+    puts(" RETRY ");
+    put_dec(i2c_stats[dev].retries);
+    puts(" TIMEOUT ");
+    put_dec(i2c_stats[dev].timeouts);
+    puts("\n\r");
+}
 
-        o = 1;
-        if (over_flow == 0) 
+// Download steps, one UART line (ASCII) or frame (binary) per download_task() call
+#define DL_IDLE          0
+#define DL_RECORDS       1
+#define DL_EEPROM_STATS  2
+#define DL_RTC_STATS     3
+#define DL_BIN_HEADER    4
+#define DL_BIN_RECORDS   5
+#define DL_BIN_END       6
+#define DL_LOG_STATS     7
+#define DL_LINE_MAX      28   // Longest line: "LOG 65535 FIRST 4294967295\n\r"
+
+#define DL_MODE_ASCII    0
+#define DL_MODE_BINARY   1
+
+#define DL_ACK_TICKS     TIMER1_TICKS(DL_ACK_MS)  // 20 Timer1 ticks of 50ms (timer.h)
+#define DL_CURSOR_OFFSET 8    // 4 bytes per host, after the log epoch (event_log.h)
+#define DL_CURSOR_ADDR   (EEP_CONFIG_START + DL_CURSOR_OFFSET)
+
+#if DL_CURSOR_OFFSET + 4 * DL_HOSTS > EEP_CONFIG_BYTES
+#error "Download cursors end past EEP_CONFIG_BYTES (eep_cache.h)"
+#endif
+
+static unsigned char dl_step = DL_IDLE;
+static unsigned long dl_first;  // Sequence number of the first record sent
+static unsigned long dl_seq;    // Sequence number of the next record
+static unsigned long dl_end;    // Sequence number after the last record to send
+
+static unsigned char dl_frame;      // Number of the frame being sent
+static unsigned char dl_frame_len;  // Records in the record frame being sent
+static unsigned char dl_wait;       // Frame sent, waiting for ACK/NAK
+static unsigned char dl_answer;     // ACK/NAK byte received, its frame number comes next (0 = none)
+static unsigned char dl_retries;    // Resends of the current frame
+static volatile unsigned char dl_timer;  // Timer1 ticks left for the ACK
+static unsigned char dl_crc;        // CRC-8 of the frame being sent
+
+static unsigned char dl_host = DL_NO_HOST;  // Host whose download cursor follows the ACKs
+static unsigned char dl_acked;      // Record frames ACKed since the cursor was last stored
+
+// Sequence number after the last record the host ACKed, 0 (everything) if it cannot be read
+static unsigned long read_cursor(unsigned char host)
+{
+    unsigned long cursor = 0;
+    unsigned char byte;
+
+    for (unsigned char n = 0; n < 4; n++)
+    {
+        if (eep_cache_read(DL_CURSOR_ADDR + 4 * host + n, &byte) != I2C_OK)
+            return 0;           // The host drops the records it already has by seq
+        cursor = (cursor << 8) | byte;
+    }
+    return cursor;
+}
+
+// Stores dl_seq as the host's cursor; the cache writes it back when the EEPROM is free
+static void write_cursor(void)
+{
+    if (dl_host == DL_NO_HOST)
+        return;
+    for (unsigned char n = 0; n < 4; n++)
+    {
+        if (eep_cache_write(DL_CURSOR_ADDR + 4 * dl_host + n, dl_seq >> (24 - 8 * n)) != I2C_OK)
+            return;             // dl_acked kept, so the next ACKed frame tries again
+    }
+    dl_acked = 0;
+}
+
+// Index of the record with sequence number dl_seq, 0 if there is none left
+static unsigned char find_record(unsigned short *n)
+{
+    unsigned short total = log_count();
+    unsigned long oldest;
+
+    if (total == 0)
+        return 0;                   // Log cleared meanwhile
+    oldest = log_seq(0);
+    if (dl_seq < oldest)
+        dl_seq = oldest;            // Overwritten since the download started
+    if (dl_seq >= dl_end || dl_seq - oldest >= total)
+        return 0;
+    *n = dl_seq - oldest;
+    return 1;
+}
+
+// Sends the record with sequence number dl_seq as one text line, 0 if there is none left
+static unsigned char put_record(void)
+{
+    log_entry_t entry;
+    unsigned char hms[3];
+    unsigned short n;
+
+    if (!find_record(&n))
+        return 0;
+
+    put_dec(dl_seq++ - dl_first);
+    putch(' ');
+
+    if (!log_read(n, &entry))  // Whole record, one transaction
+    {
+        puts("CRC ERROR\n\r");  // Torn or corrupted slot
+        return 1;
+    }
+    log_seconds_to_hms(entry.seconds, hms);
+
+    putch(hms[0] / 10 + '0');
+    putch(hms[0] % 10 + '0');
+    putch(':');
+
+    putch(hms[1] / 10 + '0');
+    putch(hms[1] % 10 + '0');
+    putch(':');
+
+    putch(hms[2] / 10 + '0');
+    putch(hms[2] % 10 + '0');
+    putch(' ');
+
+    puts(event[entry.event]);
+    putch(' ');
+
+    putch(entry.speed / 10 + '0');
+    putch(entry.speed % 10 + '0');
+    puts("\n\r");
+    return 1;
+}
+
+static void put_frame_byte(unsigned char byte)
+{
+    dl_crc = crc8(dl_crc, &byte, 1);
+    putch(byte);
+}
+
+static void put_frame_long(unsigned long value)
+{
+    for (unsigned char n = 0; n < 4; n++)
+    {
+        put_frame_byte(value >> 24);  // Most significant byte first
+        value <<= 8;
+    }
+}
+
+static void put_frame_start(unsigned char type, unsigned char len)
+{
+    putch(DL_SOF);
+    dl_crc = CRC8_INIT;
+    put_frame_byte(type);
+    put_frame_byte(dl_frame);
+    put_frame_byte(len);
+}
+
+// Builds the frame for dl_step from the log; a resend builds the same frame again
+static void put_frame(void)
+{
+    unsigned short n, total;
+
+    if (dl_step == DL_BIN_HEADER)
+    {
+        total = dl_end - dl_first;
+        put_frame_start(DL_FRAME_HEADER, DL_HEADER_LEN);
+        put_frame_byte(DL_PROTO_VERSION);
+        put_frame_byte(LOG_RECORD_SIZE);
+        put_frame_byte(total >> 8);
+        put_frame_byte(total & 0xFF);
+        put_frame_long(dl_first);
+    }
+    else if (dl_step == DL_BIN_RECORDS && find_record(&n))
+    {
+        total = log_count() - n;
+        dl_frame_len = DL_RECORDS_PER_FRAME;
+        if (dl_frame_len > total)
+            dl_frame_len = total;
+        if (dl_frame_len > dl_end - dl_seq)
+            dl_frame_len = dl_end - dl_seq;
+
+        put_frame_start(DL_FRAME_RECORDS, 4 + dl_frame_len * LOG_RECORD_SIZE);
+        put_frame_long(dl_seq);
+        for (unsigned char k = 0; k < dl_frame_len; k++)
         {
-            start = 0;
-            end = val;
-        } else {
-            end = 10;
-            start = val * 5;
+            log_entry_t entry;
+            unsigned char rec[LOG_RECORD_SIZE] = {0xFF, 0xFF, 0xFF, 0xFF};  // Bad slot: never unpacks
+
+            if (log_read(n + k, &entry))
+                log_record_pack(&entry, 0, rec);
+            for (unsigned char b = 0; b < LOG_RECORD_SIZE; b++)
+                put_frame_byte(rec[b]);
         }
+    }
+    else
+    {
+        dl_step = DL_BIN_END;       // No records left
+        put_frame_start(DL_FRAME_END, 0);
+    }
+    putch(dl_crc);
+}
+
+// Host ACKed the current frame
+static void next_frame(void)
+{
+    if (dl_step == DL_BIN_HEADER)
+        dl_step = DL_BIN_RECORDS;
+    else if (dl_step == DL_BIN_RECORDS)
+    {
+        dl_seq += dl_frame_len;
+        if (++dl_acked == DL_CURSOR_FRAMES)
+            write_cursor();         // A dropped download resumes from here
+    }
+    else
+    {
+        write_cursor();             // Everything up to dl_seq reached the host
+        dl_step = DL_IDLE;          // End frame ACKed, download complete
+    }
+    dl_frame++;
+    dl_retries = 0;
+}
+
+static void binary_task(void)
+{
+    unsigned char byte;
 
-        for (i = 0; i < end; i++) 
+    if (dl_wait)
+    {
+        while (uart_read(&byte))
         {
-            putch(i + '0');
-            putch(' ');
+            if (!dl_answer)
+            {
+                if (byte == DL_ACK || byte == DL_NAK)
+                    dl_answer = byte;   // Frame number follows
+                continue;
+            }
+            if (byte != dl_frame)
+            {
+                dl_answer = 0;      // Late answer for an earlier frame
+                continue;
+            }
+            if (dl_answer == DL_ACK)
+                next_frame();
+            else
+                dl_retries++;       // Send the same frame again
+            dl_answer = 0;
+            dl_wait = 0;
+            break;
+        }
+        if (dl_wait)
+        {
+            if (dl_timer)
+                return;             // Still waiting for the host
+            dl_wait = 0;            // No answer, send it again
+            dl_retries++;
+        }
+        if (dl_retries > DL_MAX_RETRIES)
+        {
+            write_cursor();         // Keep what the host has ACKed so far
+            dl_step = DL_IDLE;      // Host gone, drop the download
+            return;
+        }
+        if (dl_step == DL_IDLE)
+            return;
+    }
 
-            putch((read_ext_eep(start) >> 4) + '0');
-            putch((read_ext_eep(start) & 0x0F) + '0');
-            putch(':');
+    if (uart_tx_free() < DL_FRAME_MAX)
+        return;                     // Wait until the whole frame fits
+    put_frame();
+    dl_timer = DL_ACK_TICKS;
+    dl_wait = 1;
+}
 
-            putch((read_ext_eep(start + 1) >> 4) + '0');
-            putch((read_ext_eep(start + 1) & 0x0F) + '0');
-            putch(':');
+// Sends the records from sequence number 'from' on (0 = all)
+static void download_start(unsigned char mode, unsigned char host, unsigned long from)
+{
+    unsigned short total = log_count();  // Oldest record first
+    unsigned long oldest = total ? log_seq(0) : from;
 
-            putch((read_ext_eep(start + 2) >> 4) + '0');
-            putch((read_ext_eep(start + 2) & 0x0F) + '0');
-            putch(' ');
+    dl_end = oldest + total;            // Records logged from now on are not sent
+    if (from < oldest || from > dl_end)
+        from = oldest;                  // Overwritten or cleared since, or a cursor from an older log
+    dl_first = dl_seq = from;
+    dl_host = host;
+    dl_acked = 0;
 
-            puts(event[read_ext_eep(start + 3)]);
-            putch(' ');
+    if (mode == DL_MODE_BINARY)
+    {
+        dl_frame = 0;
+        dl_wait = 0;
+        dl_answer = 0;
+        dl_retries = 0;
+        dl_step = DL_BIN_HEADER;
+        return;
+    }
 
-            putch((read_ext_eep(start + 4) >> 4) + '0');
-            putch((read_ext_eep(start + 4) & 0x0F) + '0');
-            puts("\n\r");
+    puts("Logs from ");
+    put_dec(dl_first);                  // Line numbers below count from this sequence number
+    puts(":\n\r");
+    puts("#  TIME  EVENT SPEED\n\r");
+    dl_step = DL_RECORDS;               // download_task() sends them from the main loop
+}
 
-            start = (start + 5) % 50;
-        }
+unsigned char download_busy(void)
+{
+    return dl_step != DL_IDLE;
+}
+
+void download_ascii(unsigned long from)
+{
+    if (dl_step == DL_IDLE)
+        download_start(DL_MODE_ASCII, DL_NO_HOST, from);
+}
 
-        char temp = index;
-        index = 8;
-        save_log();
-        index = temp;
+void download_binary(unsigned char host)
+{
+    if (dl_step != DL_IDLE)
+        return;
+    if (host < DL_HOSTS)
+        download_start(DL_MODE_BINARY, host, read_cursor(host));  // New records only
+    else
+        download_start(DL_MODE_BINARY, DL_NO_HOST, 0);
+}
+
+void download_stats(void)
+{
+    if (dl_step == DL_IDLE)
+        dl_step = DL_LOG_STATS;         // Counters only, no records
+}
+
+void download_task(void)
+{
+    if (dl_step == DL_IDLE)
+        return;                         // Started by download_log() or the console (console.c)
+    if (dl_step >= DL_BIN_HEADER && dl_step <= DL_BIN_END)
+    {
+        binary_task();
+        return;
     }
 
+    if (uart_tx_free() < DL_LINE_MAX)
+        return;                     // Wait until the line fits
+
+    if (dl_step == DL_RECORDS)
+    {
+        if (!put_record())
+            dl_step = DL_EEPROM_STATS;
+    }
+    else if (dl_step == DL_LOG_STATS)
+    {
+        unsigned short total = log_count();
+
+        puts("LOG ");
+        put_dec(total);
+        puts(" FIRST ");
+        put_dec(total ? log_seq(0) : 0);  // Sequence number of the oldest record
+        puts("\n\r");
+        dl_step = DL_EEPROM_STATS;
+    }
+    else if (dl_step == DL_EEPROM_STATS)
+    {
+        put_i2c_stats("EEPROM", I2C_DEV_EEPROM);  // Bus health since power-up
+        dl_step = DL_RTC_STATS;
+    }
+    else
+    {
+        put_i2c_stats("DS1307", I2C_DEV_DS1307);
+        dl_step = DL_IDLE;          // Download complete
+    }
+}
+
+void download_tick(void)
+{
+    if (dl_timer)
+        dl_timer--;
+}
+
+void download_log() 
+{
+    if (o == 0) 
+    {
+        if (dl_step != DL_IDLE)
+            return;                 // A binary download is still running
+
+        clcd_clear();
+        clcd_print("Downloading...", LINE1(0));
+
+        o = 1;
+        download_start(DL_MODE_ASCII, DL_NO_HOST, 0);  // Whole log in ASCII for terminals, no log slot used
+    }
+
+    if (dl_step != DL_IDLE)
+        return;                     // Still streaming
+
     clcd_print("Download Log", LINE1(0));
     clcd_print("Successfully", LINE2(0));
 
@@ -81,7 +441,7 @@ void download_log()
         o = 0;
         i = 0;
         main_f = MENU;
-        CLEAR_DISP_SCREEN;
+        clcd_clear();
     }
 }
 
@@ -89,50 +449,75 @@ void download_log()
 
 void download_log() {
     if (o == 0) {
-        CLEAR_DISP_SCREEN;
+        clcd_clear();
         clcd_print("Downloading...", LINE1(0));
 ? Ensures the log download starts only once (o == 0).
 
-CLEAR_DISP_SCREEN; ? Clears the LCD screen.
+clcd_clear(); ? Clears the LCD screen.
 clcd_print("Downloading...", LINE1(0)); ? Displays a message on the LCD to inform the user.
-2?? Initialize UART & Print Headers
+2?? Print Headers
 
- *         init_uart();
-        puts("Logs:\n\r");
+        puts("Logs from ");
+        put_dec(dl_first);
+        puts(":\n\r");
         puts("#  TIME  EVENT SPEED\n\r");
 ? Initializes UART communication and sends log headers to the PC.
 
-init_uart(); ? Sets up the UART module for serial communication.
-puts("Logs:\n\r"); ? Sends "Logs:\n\r" to the PC via UART.
+The UART is set up once at boot (init_config()), so a download never
+resets the TX ring while it still holds data.
+puts("Logs from "); ? Sends the sequence number of the first record; the line
+numbers below count from it, so a "dump since" (console.c) can be matched up.
 puts("# TIME EVENT SPEED\n\r"); ? Sends column headers for the logs.
 ? PC Terminal Output Example:
 
 makefile
 
-Logs:
+Logs from 0:
 #  TIME  EVENT SPEED
 3?? Determine Start & End Points for Log Retrieval
 
         o = 1;
-        if (over_flow == 0) {
-            start = 0;
-            end = val;
-        } else {
-            end = 10;
-            start = val * 5;
-        }
-? Calculates the range of stored logs to be sent.
-
-over_flow == 0 ? Logs are within 50 entries, so we start from 0 and read until val (current log count).
-over_flow == 1 ? More than 50 logs exist; reads the last 10 logs from the EEPROM.
-4?? Loop Through Stored Logs & Send Data via UART
-
-        for (i = 0; i < end; i++) {
-            putch(i + '0');
-            putch(' ');
-? Loops through each stored log and sends it over UART.
+        download_start(DL_MODE_ASCII, DL_NO_HOST, 0);
+
+    unsigned short total = log_count();  // Oldest record first
+    unsigned long oldest = total ? log_seq(0) : from;
+
+    dl_end = oldest + total;
+    if (from < oldest || from > dl_end)
+        from = oldest;
+    dl_first = dl_seq = from;
+    dl_step = DL_RECORDS;
+? Asks the log engine (event_log.c) how many records are stored and
+remembers them by sequence number. download_log() itself sends nothing
+else: download_task(), called once per main loop pass, sends one line
+whenever the UART TX ring has room for it (DL_LINE_MAX bytes). The main
+loop, the dashboard and event logging keep running while the download
+streams out; at 9600 baud one record line takes about 20 ms on the wire.
+
+? Records are tracked by sequence number rather than position, so records
+logged during the download do not shift the ones still to be sent. If the
+log wraps over a record before it is sent, the download skips ahead to the
+oldest one still stored.
+
+log_read(n, &entry) returns record n counted from the oldest one, so the
+download order is the same whether or not the circular log has wrapped.
+The count is 16-bit because a 24C512 holds thousands of records.
+4?? put_record() - Send One Log Line via UART
+
+    put_dec(dl_seq - dl_first);
+    putch(' ');
+
+    if (!log_read(dl_seq++ - oldest, &entry))  // Whole record, one transaction
+    {
+        puts("CRC ERROR\n\r");  // Torn or corrupted slot
+        return 1;
+    }
+    log_seconds_to_hms(entry.seconds, hms);
+? Sends one stored log over UART per call.
 
-Sends log index (i) followed by a space (' ').
+Sends the log index (n, without leading zeros) followed by a space (' ').
+A record that fails its CRC or commit check is sent as "CRC ERROR" and
+skipped, so one bad slot never stops the download.
 ? Sending Log Time (HH:MM:SS)
 
             putch((read_ext_eep(start) >> 4) + '0');
@@ -199,16 +584,12 @@ Edit
 
 Each log entry occupies 5 bytes (HH MM SS EVENT SPEED).
 Wraps around when it reaches 50 entries (circular logging).
-6?? Save Log Index & Restore Original Index
+6?? No Download Marker Record
 
-        char temp = index;
-        index = 8;
-        save_log();
-        index = temp;
-? Temporarily updates index = 8 while saving the log status.
-
-Saves current log index (save_log()).
-Restores previous index (index = temp).
+? Earlier versions stored a "DL" record (index = 8, save_log()) after every
+download, which used up a log slot per pull. A download no longer writes to
+the log; hosts that need to know what they already have use the download
+cursor below.
 7?? Display "Download Successful" & Return to Menu
 
     clcd_print("Download Log", LINE1(0));
@@ -219,7 +600,7 @@ Restores previous index (index = temp).
         o = 0;
         i = 0;
         main_f = MENU;
-        CLEAR_DISP_SCREEN;
+        clcd_clear();
     }
 }
 ? Displays success message on the LCD and resets variables.
@@ -230,20 +611,73 @@ mathematica
 Download Log
 Successfully
 Waits before clearing the screen and returning to MENU.
+
+8?? Binary Download Mode
+
+? The ASCII dump above needs about 22 characters per 4-byte record and has
+no integrity check. When the host sends DL_CMD_BINARY ('B') at the start of
+a console line while no download is running, the console (console.c) calls
+download_binary() and a binary download runs instead (frame layout in
+download_log.h):
+
+Frame		Payload
+'H' header	version, record size, record count, first sequence number
+'R' records	sequence number, up to 4 packed records (4 bytes each)
+'E' end		none
+
+? Every frame ends with a CRC-8 and is sent only when it fits in the UART
+TX ring. The device then waits for DL_ACK (next frame) or DL_NAK (same
+frame again), each followed by the frame number; no answer within DL_ACK_MS
+(1 s) also resends it. Answers carrying another frame's number are read and
+dropped, so a duplicate ACK for a resent frame cannot skip a frame. A
+resend is built from the log again by put_frame(), so no frame buffer is
+kept in RAM. A record frame costs 25 bytes for 4 records, about 6 bytes per
+record against 22 in ASCII.
+
+9?? Incremental Download (Download Cursor)
+
+? DL_CMD_SINCE ('I') followed by a host number 0..DL_HOSTS-1 starts a
+binary download from that host's cursor instead of the oldest record:
+
+Config byte			Content
+EEP_CONFIG_START + 8 + 4*host	Cursor of the host, 4 bytes, most significant first
+
+? The cursor is the sequence number after the last record the host ACKed.
+It is stored through the EEPROM cache (eep_cache.c) every DL_CURSOR_FRAMES
+ACKed record frames, when the end frame is ACKed and when the download is
+dropped, so a daily pull sends only the records logged since the last one
+and a broken transfer resumes at most DL_CURSOR_FRAMES frames back.
+A cursor below the oldest stored record (overwritten or cleared since) or
+beyond the newest one (fresh EEPROM) starts at the oldest record.
  * 
  * 
 ? Summary of download_log.c
 Function                      	Purpose
-download_log()                Transfers logs from EEPROM to PC via UART
-init_uart()             	  Initializes UART communication
+download_log()                Starts the download and shows its progress on the LCD
+download_task()               Sends the next download line when the UART has room
+download_ascii/binary/stats() Start a download from the UART console
 puts("# TIME EVENT SPEED")	  Prints headers on the PC terminal
 putch()                       Sends characters via UART
-read_ext_eep(start + X)        Reads logs from EEPROM (time, event, speed)
+log_read(i, &entry)            Reads one packed log record from EEPROM (time, event, speed)
+put_record()                  Sends one log line
+put_frame()                   Sends one CRC-protected binary frame
+download_tick()               Counts down the ACK timeout (Timer1 ISR)
+read_cursor() / write_cursor() Load / store a host's download cursor
+put_i2c_stats(name, dev)      Sends the I2C error/retry/timeout counters of one device
  * 
  * 
 ? Final PC Terminal Output Example:
 
+Logs from 0:
 #  TIME  EVENT SPEED
 0  12:30:45  GR  40
 1  12:35:22  G2  55
-2  12:40:11  G3  65*/
\ No newline at end of file
+2  12:40:11  G3  65
+EEPROM ERR 0 RETRY 3 TIMEOUT 0
+DS1307 ERR 0 RETRY 0 TIMEOUT 0
+
+? Console "stats" sends the counters only, led by the log line:
+
+LOG 3 FIRST 0
+EEPROM ERR 0 RETRY 3 TIMEOUT 0
+DS1307 ERR 0 RETRY 0 TIMEOUT 0*/
\ No newline at end of file
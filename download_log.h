@@ -0,0 +1,115 @@
+/*
+ ? Step 39: Setting Up download_log.h (Log Download Protocol Header File)
+This file (download_log.h) is needed to:
+? Define the framed binary download protocol (frame layout, ACK/NAK bytes).
+? Declare the background download functions called from main() and isr.c.
+? Keep the protocol in one place so the firmware and the host tool agree.
+
+This header does not include <xc.h> so it can also be used by host tools.
+*/
+
+#ifndef DOWNLOAD_LOG_H
+#define DOWNLOAD_LOG_H
+
+#include "log_record.h"
+#include "crc8.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Binary download protocol
+#define DL_PROTO_VERSION      1
+#define DL_CMD_BINARY         'B'   // Host -> device: start a binary download (at the start of a console line)
+#define DL_CMD_SINCE          'I'   // Host -> device: 'I' + host number, binary download of new records only
+#define DL_ACK                0x06  // Host -> device: frame received, send the next one (+ frame number)
+#define DL_NAK                0x15  // Host -> device: frame bad, send it again (+ frame number)
+#define DL_SOF                0xA5  // Start of every frame
+
+#define DL_FRAME_HEADER       'H'   // Payload: version, record size, count (2), first sequence number (4)
+#define DL_FRAME_RECORDS      'R'   // Payload: sequence number of the first record (4), packed records
+#define DL_FRAME_END          'E'   // No payload, download complete
+
+#define DL_HEADER_LEN         8     // Payload bytes of a header frame
+#define DL_FRAME_OVERHEAD     5     // SOF, type, frame number, payload length, CRC-8
+#define DL_RECORDS_PER_FRAME  4
+#define DL_FRAME_MAX          (DL_FRAME_OVERHEAD + 4 + DL_RECORDS_PER_FRAME * LOG_RECORD_SIZE)
+
+#define DL_ACK_MS             1000  // Time to wait for ACK/NAK before resending (ms)
+#define DL_MAX_RETRIES        5     // Resends of one frame before the download is dropped
+
+#define DL_HOSTS              4     // Hosts with their own download cursor (host number 0..3)
+#define DL_CURSOR_FRAMES      8     // Record frames ACKed between cursor updates in EEPROM
+#define DL_NO_HOST            0xFF  // download_binary(): all records, no cursor
+
+// Function Prototypes
+void download_task(void);   // Send the next download line/frame when the UART has room
+void download_tick(void);   // Timer1 ISR: ACK timeout
+unsigned char download_busy(void);         // 1 while a download or stats dump is being sent
+void download_ascii(unsigned long from);   // ASCII dump from sequence number 'from' (0 = all)
+void download_binary(unsigned char host);  // Binary download: new records of host, or all (DL_NO_HOST)
+void download_stats(void);                 // Log and I2C counters as text
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
+
+/*
+ 1 - Frame Layout (binary mode)
+
+Byte	Content
+0	DL_SOF (0xA5)
+1	Frame type: 'H', 'R' or 'E'
+2	Frame number, 0 for the header, +1 per new frame (wraps at 256)
+3	Payload length n
+4..3+n	Payload (multi-byte numbers most significant byte first)
+4+n	CRC-8 (crc8.h) of bytes 1..3+n
+
+? A download is: one header frame, record frames of up to
+DL_RECORDS_PER_FRAME packed records (log_record.h format, lap bit 0), and
+one end frame. A record that fails its CRC check on the device is sent as
+FF FF FF FF, which log_record_unpack() rejects.
+
+? After each frame the device waits for a two-byte answer:
+
+Byte	Content
+0	DL_ACK or DL_NAK
+1	Number of the frame the answer is for
+
+DL_ACK moves on to the next frame, DL_NAK (or no answer within DL_ACK_MS)
+sends the same frame again with the same frame number. An answer whose
+number is not the frame being sent is ignored, so the second ACK of a
+frame that was resent after a timeout can never be taken for the next
+frame. A host that sees a frame number twice (its ACK was lost) ACKs it
+again and drops the copy. A host that gets a bad frame cannot trust its
+number byte, so it NAKs the number it is waiting for (one more than the
+last frame it took, 0 for the header) and answers nothing else until a
+good frame arrives. After DL_MAX_RETRIES resends the device gives up.
+
+? Each record frame carries the sequence number of its first record, so
+the host can tell if records were overwritten by the log while the
+download was running.
+
+? Incremental download: DL_CMD_SINCE followed by a host number
+(0..DL_HOSTS-1) starts the same frame sequence, but only with the records
+that host has not ACKed yet. The device keeps one download cursor per host
+in the EEPROM config area: the sequence number after the last record the
+host ACKed. The cursor moves every DL_CURSOR_FRAMES record frames and when
+the download ends or is dropped, so an interrupted transfer resumes close
+to where it stopped; a record frame sent twice is recognised by its
+sequence number. The header frame gives the first sequence number sent,
+so a host can see that records were overwritten since its last pull.
+
+2 - Function Prototypes (Used in download_log.c)
+
+download_task()  ? Called once per main loop pass, sends the next ASCII line or
+                   binary frame.
+download_busy()  ? The console (console.c) leaves received bytes to the download
+                   while this is 1, they are its ACK/NAK bytes.
+download_ascii(from), download_binary(host), download_stats()
+                 ? Start a download; called by the console for "dump", DL_CMD_BINARY /
+                   DL_CMD_SINCE and "stats". Ignored while another one is running.
+download_tick()  ? Called from the Timer1 interrupt, counts down the ACK timeout.
+*/
@@ -14,33 +14,149 @@ This file implements functions to communicate with the DS1307 RTC using I2C prot
 #include <xc.h>
 #include "ds1307.h"
 #include "i2c.h"
+#include "i2c_queue.h"
+#include "matrix_keypad.h"
+
+// RB0/INT is keypad column 0 on this board: every key in that column would
+// tick the clock, and the 1 Hz SQW would read as a key press
+#if RTC_USE_SQW && (MATRIX_KEYPAD_COL_MASK & 0x01)
+#error "RTC_USE_SQW needs RB0 free: move keypad column 0 off RB0 (MATRIX_KEYPAD_COL_MASK, scan_key())"
+#endif
 
 char rtc_time[9] = "12:00:00";  // Renamed from time[] to rtc_time[]
 unsigned char clock_reg[3];  // Stores raw values read from DS1307
 
-unsigned char read_ds1307(unsigned char address) {
-    i2c_start();
-    i2c_write(SLAVE_WRITE);
-    i2c_write(address);
-    i2c_rep_start();
-    i2c_write(SLAVE_READ);
-    unsigned char data = i2c_read();
-    i2c_stop();
-    return data;
+rtc_t rtc_now;                      // Time and date from the last burst read
+
+static i2c_txn_t rtc_txn;           // Background burst read of registers 0x00-0x06
+static rtc_t rtc_buf;               // Filled by rtc_txn, copied to rtc_now when complete
+
+static unsigned char rtc_ticks;             // Timer1 ticks into the current second
+static volatile unsigned char rtc_changed;  // Software clock advanced since the last get_time()
+static volatile unsigned char rtc_sync_due = 1;  // Re-read the DS1307 (boot, then once a minute)
+
+unsigned char read_ds1307(unsigned char address, unsigned char *data) {
+    unsigned char status, tries = 0;
+
+    do {
+        i2c_set_speed(I2C_SSPADD(I2C_DS1307_HZ));  // DS1307 is a 100 kHz part
+        i2c_start();
+        i2c_write(SLAVE_WRITE);
+        i2c_write(address);
+        i2c_rep_start();
+        i2c_write(SLAVE_READ);
+        *data = i2c_read();
+        i2c_nack();             // Only one byte wanted
+        status = i2c_stop();
+    } while (i2c_retry(I2C_DEV_DS1307, status, &tries));
+    return status;
 }
 
-void write_ds1307(unsigned char address, unsigned char data) {
-    i2c_start();
-    i2c_write(SLAVE_WRITE);
-    i2c_write(address);
-    i2c_write(data);
-    i2c_stop();
+unsigned char write_ds1307(unsigned char address, unsigned char data) {
+    unsigned char status, tries = 0;
+
+    do {
+        i2c_set_speed(I2C_SSPADD(I2C_DS1307_HZ));
+        i2c_start();
+        i2c_write(SLAVE_WRITE);
+        i2c_write(address);
+        i2c_write(data);
+        status = i2c_stop();
+    } while (i2c_retry(I2C_DEV_DS1307, status, &tries));
+    return status;
 }
 
-void get_time(void) {
-    clock_reg[0] = read_ds1307(SEC_ADDR);  // Read Seconds
-    clock_reg[1] = read_ds1307(MIN_ADDR);  // Read Minutes
-    clock_reg[2] = read_ds1307(HOUR_ADDR); // Read Hours
+unsigned char read_ds1307_time(rtc_t *t) {
+    unsigned char *reg = (unsigned char *)t;
+    unsigned char status, tries = 0;
+
+    do {
+        i2c_set_speed(I2C_SSPADD(I2C_DS1307_HZ));
+        i2c_start();
+        i2c_write(SLAVE_WRITE);
+        i2c_write(SEC_ADDR);    // Register pointer to 0x00
+        i2c_rep_start();
+        i2c_write(SLAVE_READ);
+        for (unsigned char n = 0; n < RTC_REG_COUNT - 1; n++) {
+            reg[n] = i2c_read(); // DS1307 auto-increments the register pointer
+            i2c_ack();
+        }
+        reg[RTC_REG_COUNT - 1] = i2c_read();
+        i2c_nack();             // Last register
+        status = i2c_stop();
+    } while (i2c_retry(I2C_DEV_DS1307, status, &tries));
+    return status;
+}
+
+unsigned char rtc_set_time(unsigned char hours, unsigned char minutes, unsigned char seconds) {
+    unsigned char status, tries = 0;
+
+    do {
+        i2c_set_speed(I2C_SSPADD(I2C_DS1307_HZ));
+        i2c_start();
+        i2c_write(SLAVE_WRITE);
+        i2c_write(SEC_ADDR);    // Seconds, minutes, hours in one write
+        i2c_write(seconds);     // CH = 0: oscillator running
+        i2c_write(minutes);
+        i2c_write(hours);       // Bit 6 = 0: 24-hour mode
+        status = i2c_stop();
+    } while (i2c_retry(I2C_DEV_DS1307, status, &tries));
+    if (status != I2C_OK)
+        return status;
+
+    rtc_txn.status = I2C_IDLE;  // Drop a sync read taken before the new time
+    GIE = 0;
+    rtc_now.seconds = seconds;
+    rtc_now.minutes = minutes;
+    rtc_now.hours = hours;
+    rtc_ticks = 0;              // The DS1307 restarts its second on the seconds write
+    GIE = 1;
+    rtc_changed = 1;
+    return I2C_OK;
+}
+
+static unsigned char bcd_inc(unsigned char bcd) {
+    return (bcd & 0x0F) == 9 ? (bcd & 0xF0) + 0x10 : bcd + 1;
+}
+
+// Advance the software clock by one second (ISR)
+static void rtc_advance(void) {
+    rtc_now.seconds = bcd_inc(rtc_now.seconds & 0x7F);
+    if (rtc_now.seconds == 0x60) {
+        rtc_now.seconds = 0;
+        rtc_sync_due = 1;       // New minute: re-sync from the DS1307
+        rtc_now.minutes = bcd_inc(rtc_now.minutes);
+        if (rtc_now.minutes == 0x60) {
+            rtc_now.minutes = 0;
+            rtc_now.hours = bcd_inc(rtc_now.hours & 0x3F);
+            if (rtc_now.hours == 0x24)
+                rtc_now.hours = 0;
+        }
+    }
+    rtc_changed = 1;
+}
+
+void rtc_tick(void) {
+#if !RTC_USE_SQW
+    if (++rtc_ticks >= RTC_TICKS_PER_SEC) {
+        rtc_ticks = 0;
+        rtc_advance();
+    }
+#endif
+}
+
+void rtc_sqw(void) {
+    rtc_advance();              // SQW/OUT falling edge: the DS1307 itself started a new second
+}
+
+// Refresh clock_reg[] and rtc_time[] from rtc_now
+static void rtc_update(void) {
+    GIE = 0;                    // Take a consistent copy, the ISR advances rtc_now
+    clock_reg[0] = rtc_now.seconds;
+    clock_reg[1] = rtc_now.minutes;
+    clock_reg[2] = rtc_now.hours;
+    rtc_changed = 0;
+    GIE = 1;
 
     // Convert raw BCD values to ASCII for display
     rtc_time[0] = (clock_reg[2] >> 4) + '0';
@@ -54,6 +170,61 @@ void get_time(void) {
     rtc_time[8] = '\0';  // Null-terminate the string
 }
 
+void init_ds1307(void) {
+    if (read_ds1307_time(&rtc_buf) != I2C_OK)
+        return;                 // No RTC: keep the default time, get_time() keeps trying
+
+    GIE = 0;
+    rtc_now = rtc_buf;          // Timer1 is already advancing rtc_now
+    rtc_ticks = 0;
+    GIE = 1;
+    if (rtc_now.seconds & 0x80) {
+        rtc_now.seconds &= 0x7F;
+        write_ds1307(SEC_ADDR, rtc_now.seconds);  // Clear CH: start the oscillator, keep the time
+    }
+#if RTC_USE_SQW
+    write_ds1307(CONTROL_ADDR, 0x10);  // SQWE = 1, RS1:RS0 = 00: 1 Hz on SQW/OUT
+    TRISB0 = 1;                 // SQW/OUT (open drain, pulled up) on RB0/INT
+    INTEDG = 0;                 // Falling edge
+    INTF = 0;
+    INTE = 1;
+#endif
+    rtc_sync_due = 0;           // Just read
+    rtc_update();
+}
+
+void get_time(void) {
+    if (rtc_txn.status == I2C_DONE) {
+        GIE = 0;
+        rtc_now = rtc_buf;      // All seven registers from one coherent read
+        rtc_ticks = 0;          // Second starts now (within one Timer1 tick)
+        GIE = 1;
+        rtc_txn.status = I2C_IDLE;
+        rtc_changed = 1;
+    } else if (rtc_txn.status == I2C_NACK || rtc_txn.status == I2C_TIMEOUT) {
+        if (rtc_txn.status == I2C_NACK)
+            i2c_stats[I2C_DEV_DS1307].errors++;  // Timeouts are counted by the queue
+        rtc_txn.status = I2C_IDLE;  // Keep running on the software clock, retry next minute
+    }
+
+    if (rtc_sync_due && !I2C_PENDING(&rtc_txn)) {
+        // One write-then-read of registers 0x00-0x06, runs from the ISR
+        rtc_txn.addr = SLAVE_WRITE;
+        rtc_txn.sspadd = I2C_SSPADD(I2C_DS1307_HZ);
+        rtc_txn.dev = I2C_DEV_DS1307;
+        rtc_txn.cmd[0] = SEC_ADDR;
+        rtc_txn.cmd_len = 1;
+        rtc_txn.tx_len = 0;
+        rtc_txn.rx = (unsigned char *)&rtc_buf;
+        rtc_txn.rx_len = RTC_REG_COUNT;
+        if (i2c_queue_submit(&rtc_txn))
+            rtc_sync_due = 0;
+    }
+
+    if (rtc_changed)
+        rtc_update();           // RAM only, no bus access
+}
+
 
 /*
  ? Explanation of ds1307.c (RTC - Real-Time Clock Implementation)
@@ -76,6 +247,12 @@ void init_ds1307(void)
 Calls write_ds1307() to set the seconds register (0x00) to 00.
 Ensures time starts correctly when the system powers on.
 
+? Now init_ds1307() burst-reads the clock (read_ds1307_time()) instead, so
+the time kept by the backup battery survives a reset. Only if the CH bit
+is set (oscillator halted) is the seconds register rewritten, with CH
+cleared and the seconds kept. clock_reg[] is valid before the first log
+record is written.
+
 2 - write_ds1307() - Write Data to DS1307 RTC
 
 void write_ds1307(unsigned char address, unsigned char data) 
@@ -157,11 +334,47 @@ get_time();
 clcd_print(time, LINE1(0));  // Display time on LCD
 ? Displays the current HH:MM:SS on the LCD.
 
+? get_time() no longer reads the DS1307 on every call. rtc_now is a software
+clock advanced once a second from the ISR: every RTC_TICKS_PER_SEC Timer1
+ticks (rtc_tick()), or, with RTC_USE_SQW = 1, on each falling edge of the
+DS1307 SQW/OUT 1 Hz output wired to RB0/INT (rtc_sqw()). get_time() only
+copies rtc_now into clock_reg[] and rtc_time[] when the second changed.
+
+? On the stock board RB0 is keypad column 0 (scan_key() reads RB0..RB2), so
+RTC_USE_SQW = 1 stops the build with #error. Using it needs a rewire:
+move keypad column 0 to a free pin, change scan_key() and
+MATRIX_KEYPAD_COL_MASK to match, and wire SQW/OUT (with its pull-up) to
+RB0/INT alone. Otherwise every key in that column would tick the clock and
+each SQW pulse would read as a key press.
+
+? Once a minute (and at boot) get_time() queues one background read of
+registers 0x00-0x06 through i2c_queue.c and, when it completes, loads
+rtc_now from it, so Timer1 drift never exceeds one minute's worth. That is
+one I2C transaction per minute instead of several per main loop pass. The
+date registers are refreshed by the same read; a midnight rollover
+advances the date at the next sync.
+
+? The DS1307 copies its time registers into a read buffer at every START,
+so all seven bytes of one burst belong to the same second; separate reads
+of seconds, minutes and hours could straddle a rollover (12:59:59 read as
+12:59:00 + 13:00 = 13:59:59). One transaction also replaces three
+start/restart/stop sequences. A read that
+fails (NACK or watchdog timeout) keeps the last time and is counted in
+i2c_stats[I2C_DEV_DS1307].
+
+? rtc_set_time() writes seconds, minutes and hours in one transaction, so
+the DS1307 cannot roll over between them, and loads the same values into
+rtc_now. A sync read that completed before the write is dropped, otherwise
+get_time() would put the old time back.
+
 ? Summary of ds1307.c
 Function	Purpose
 init_ds1307()	Initializes the DS1307 RTC
 write_ds1307(address, data)	Writes data to a register in DS1307
-read_ds1307(address)	Reads data from a register in DS1307
+read_ds1307(address, &data)	Reads data from a register in DS1307, returns the I2C status
+read_ds1307_time(&t)	Reads time and date (0x00-0x06) in one burst
+rtc_set_time(h, m, s)	Sets the DS1307 and the software clock (console "settime")
+rtc_tick() / rtc_sqw()	Advance the software clock from the ISR
 get_time()	Reads current time and formats it for display*/
 
 
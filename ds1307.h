@@ -11,6 +11,7 @@ The RTC Header File (ds1307.h) is needed to:
 #define DS1307_H
 
 #include <xc.h>
+#include "timer.h"
 
 #define SLAVE_WRITE  0xD0  // DS1307 Write Address
 #define SLAVE_READ   0xD1  // DS1307 Read Address
@@ -18,13 +19,42 @@ The RTC Header File (ds1307.h) is needed to:
 #define SEC_ADDR     0x00  // Register address for Seconds
 #define MIN_ADDR     0x01  // Register address for Minutes
 #define HOUR_ADDR    0x02  // Register address for Hours
+#define DAY_ADDR     0x03  // Register address for Day of week (1-7)
+#define DATE_ADDR    0x04  // Register address for Date
+#define MONTH_ADDR   0x05  // Register address for Month
+#define YEAR_ADDR    0x06  // Register address for Year
+#define CONTROL_ADDR 0x07  // Register address for Control (SQW/OUT)
+#define RTC_REG_COUNT 7    // Time/date registers 0x00-0x06
+
+// Software clock
+#ifndef RTC_USE_SQW
+#define RTC_USE_SQW  0     // 1: SQW/OUT wired to RB0/INT drives the clock (keypad must move off RB0)
+#endif
+#define RTC_TICKS_PER_SEC TIMER1_TICKS_PER_SEC  // Timer1 interrupts per second (timer.h)
+
+// Time/date registers in DS1307 order (all BCD)
+typedef struct {
+    unsigned char seconds;  // Bit 7 = CH (clock halt)
+    unsigned char minutes;
+    unsigned char hours;    // Bit 6 = 12/24 hour mode
+    unsigned char day;
+    unsigned char date;
+    unsigned char month;
+    unsigned char year;
+} rtc_t;
 
 // Renamed time variable to avoid conflicts with C99 standard library
 extern char rtc_time[9];  
-
-unsigned char read_ds1307(unsigned char address);
-void write_ds1307(unsigned char address, unsigned char data);
-void get_time(void);
+extern rtc_t rtc_now;       // Time and date from the last burst read
+
+void init_ds1307(void);     // Read the clock once and start the oscillator if halted
+unsigned char read_ds1307(unsigned char address, unsigned char *data);  // Returns I2C_OK / I2C_ERR_*
+unsigned char write_ds1307(unsigned char address, unsigned char data);   // Returns I2C_OK / I2C_ERR_*
+unsigned char read_ds1307_time(rtc_t *t);  // Burst read of 0x00-0x06, returns I2C_OK / I2C_ERR_*
+unsigned char rtc_set_time(unsigned char hours, unsigned char minutes, unsigned char seconds);  // BCD, 24-hour; returns I2C_OK / I2C_ERR_*
+void get_time(void);        // Refresh clock_reg[]/rtc_time[] from the software clock (RAM only)
+void rtc_tick(void);        // Timer1 ISR, every 50ms
+void rtc_sqw(void);         // RB0/INT ISR, DS1307 1 Hz output
 
 #endif
 
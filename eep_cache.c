@@ -0,0 +1,177 @@
+/*
+ * File:   eep_cache.c
+
+ ? Step 32: Setting Up eep_cache.c (EEPROM Write-Back Cache)
+This file (eep_cache.c) is responsible for:
+? Holding hot EEPROM bytes (password, log metadata) in RAM.
+? Tracking which cached lines were modified (dirty).
+? Writing dirty lines back as page writes when idle or on request.
+ */
+
+#include "eep_cache.h"
+#include "ext_eep.h"
+
+static unsigned short line_tag[EEP_CACHE_LINES];     // Line-aligned EEPROM address
+static unsigned char line_data[EEP_CACHE_LINES][EEP_CACHE_LINE_SIZE];
+static unsigned char line_valid[EEP_CACHE_LINES];    // Line holds data for line_tag
+static unsigned char line_dirty[EEP_CACHE_LINES];
+static unsigned char line_victim;   // Next line to replace (round robin)
+
+#define LINE_NONE  0xFF
+static i2c_txn_t wb_txn;                        // Background write-back
+static unsigned char wb_line = LINE_NONE;       // Line wb_txn is writing
+
+// Wait for the background write-back; a NACKed one leaves its line dirty
+static void wb_finish(void)
+{
+    if (wb_line == LINE_NONE)
+        return;
+    while (I2C_PENDING(&wb_txn))
+        i2c_queue_poll();           // A stalled write-back is aborted here
+    if (wb_txn.status != I2C_DONE)
+        line_dirty[wb_line] = 1;    // EEPROM was busy, write it again
+    wb_line = LINE_NONE;
+}
+
+// A line stays dirty until the EEPROM has acknowledged all of it
+static unsigned char write_back(unsigned char line)
+{
+    unsigned char status = I2C_OK;
+
+    if (line_valid[line] && line_dirty[line])
+    {
+        status = write_ext_eep_block(line_tag[line], line_data[line], EEP_CACHE_LINE_SIZE);
+        if (status == I2C_OK)
+            line_dirty[line] = 0;
+    }
+    return status;
+}
+
+// Finds or loads the line holding address; *line is set only when I2C_OK is returned
+static unsigned char lookup(unsigned short address, unsigned char *line)
+{
+    unsigned short tag = address & ~(EEP_CACHE_LINE_SIZE - 1);
+    unsigned char n, status;
+
+    for (n = 0; n < EEP_CACHE_LINES; n++)
+    {
+        if (line_valid[n] && line_tag[n] == tag)
+        {
+            *line = n;              // Hit
+            return I2C_OK;
+        }
+    }
+
+    // Miss: replace the victim line, writing it back first if needed
+    wb_finish();
+    n = line_victim;
+    status = write_back(n);
+    if (status != I2C_OK)
+        return status;              // Keep the dirty line rather than lose it
+    if (++line_victim == EEP_CACHE_LINES)
+        line_victim = 0;
+
+    line_valid[n] = 0;
+    status = read_ext_eep_block(tag, line_data[n], EEP_CACHE_LINE_SIZE);
+    if (status != I2C_OK)
+        return status;              // Never cache a failed read as data
+    line_tag[n] = tag;
+    line_valid[n] = 1;
+    *line = n;
+    return I2C_OK;
+}
+
+unsigned char eep_cache_read(unsigned short address, unsigned char *data)
+{
+    unsigned char line, status = lookup(address, &line);
+
+    if (status == I2C_OK)
+        *data = line_data[line][address & (EEP_CACHE_LINE_SIZE - 1)];
+    return status;
+}
+
+unsigned char eep_cache_write(unsigned short address, unsigned char data)
+{
+    unsigned char line, status = lookup(address, &line);
+    unsigned char offset = address & (EEP_CACHE_LINE_SIZE - 1);
+
+    if (status == I2C_OK && line_data[line][offset] != data)
+    {
+        line_data[line][offset] = data;
+        line_dirty[line] = 1;       // Written back later
+    }
+    return status;
+}
+
+unsigned char eep_cache_flush(void)
+{
+    unsigned char status = I2C_OK, s;
+
+    wb_finish();
+    for (unsigned char line = 0; line < EEP_CACHE_LINES; line++)
+    {
+        s = write_back(line);
+        if (status == I2C_OK)
+            status = s;             // Report the first failure, still try the other lines
+    }
+    return status;
+}
+
+void eep_cache_idle(void)
+{
+    i2c_queue_poll();                   // Main-loop half of the I2C queue watchdog
+
+    if (wb_line != LINE_NONE)
+    {
+        if (I2C_PENDING(&wb_txn))
+            return;                     // Still on the bus
+        wb_finish();                    // Done or NACKed, never waits here
+    }
+
+    for (unsigned char line = 0; line < EEP_CACHE_LINES; line++)
+    {
+        if (line_valid[line] && line_dirty[line])
+        {
+            // At most one queued page write per call; a write during it dirties the line again
+            if (write_ext_eep_async(&wb_txn, line_tag[line], line_data[line], EEP_CACHE_LINE_SIZE))
+            {
+                line_dirty[line] = 0;
+                wb_line = line;
+            }
+            return;
+        }
+    }
+}
+
+/*
+ 1 - lookup() - Find or Load a Cache Line
+
+? Compares the line-aligned address with every tag (EEP_CACHE_LINES is small).
+On a miss the round-robin victim is written back if dirty and refilled with
+one sequential read. The line becomes valid only if that read returned
+I2C_OK; otherwise it stays invalid and the I2C status is returned, and a
+victim whose write-back failed is kept (dirty) instead of being refilled.
+
+2 - eep_cache_write() - Write-Back
+
+? Only RAM is updated; writing the same value again does not dirty the line,
+so repeated writes of unchanged data never reach the EEPROM.
+
+3 - eep_cache_idle() - Background Flush
+
+? Called once per main loop pass. It queues at most one line as a background
+page write (write_ext_eep_async()) and returns at once, so the main loop
+never waits for the bus or for an EEPROM write cycle. If the EEPROM is
+still programming, the write is NACKed and the line stays dirty for the
+next pass. Blocking cache accesses call wb_finish() first, so a line is
+never refilled while the queue is still sending it. It starts with
+i2c_queue_poll(), so a transaction the I2C queue watchdog flagged is
+aborted within one main loop pass.
+
+? Summary of eep_cache.c
+    Function                          Purpose
+eep_cache_read(address, &data) Reads a byte, from RAM on a hit
+eep_cache_write(address, data) Updates a byte in RAM and marks it dirty
+eep_cache_flush()             Writes back all dirty lines
+eep_cache_idle()              Writes back one dirty line when the EEPROM is free
+ */
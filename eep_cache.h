@@ -0,0 +1,65 @@
+/*
+ ? Step 31: Setting Up eep_cache.h (EEPROM Write-Back Cache Header File)
+This file (eep_cache.h) is needed to:
+? Keep frequently used EEPROM bytes (password, log metadata) in RAM.
+? Declare the cache functions used instead of read_ext_eep()/write_ext_eep() for those bytes.
+? Let writes be collected in RAM and committed later as one page write.
+*/
+
+#ifndef EEP_CACHE_H
+#define EEP_CACHE_H
+
+#include "ext_eep.h"
+
+#define EEP_CONFIG_BYTES  24  // Config bytes in use: password, lap, epoch, download cursors
+
+#if EXT_EEP_PAGE_SIZE >= 32
+#define EEP_CACHE_LINE_SIZE  32  // Whole config block in one line, a full page would not fit in RAM
+#define EEP_CACHE_LINES      1   // Number of cache lines held in RAM
+#else
+#define EEP_CACHE_LINE_SIZE  EXT_EEP_PAGE_SIZE  // One line per EEPROM page (8 on a 24C02)
+#define EEP_CACHE_LINES      2   // Password/lap/epoch line + the cursor line of the active download
+#endif
+
+// Function Prototypes (I2C_OK / I2C_ERR_* status, see i2c.h)
+unsigned char eep_cache_read(unsigned short address, unsigned char *data);  // Read a byte through the cache
+unsigned char eep_cache_write(unsigned short address, unsigned char data);  // Write a byte into the cache (marks line dirty)
+unsigned char eep_cache_flush(void);                                        // Write all dirty lines to EEPROM
+void eep_cache_idle(void);                                                  // Flush one dirty line if the EEPROM is free
+
+#endif
+
+/*
+ 1 - Cache Lines
+
+? A line holds EEP_CACHE_LINE_SIZE bytes starting at a line-aligned EEPROM
+address. A line never crosses an EEPROM page, so a dirty line is written
+back with one write_ext_eep_block() call (one transaction, one write cycle).
+
+? Only the config area (EEP_CONFIG_START and above) is accessed through the
+cache. Log records are written directly by event_log.c.
+
+? Line size: a line is one EEPROM page on a 24C02 (8 bytes) and on 24C32/64
+(32 bytes). The 64 and 128 byte pages of the larger parts are cached as
+32-byte lines, which still hold all EEP_CONFIG_BYTES (password, lap, epoch
+and every download cursor), so one line and one page write cover the whole
+config block while only 32 bytes of the 368-byte RAM are used.
+On a 24C02 the config block spans three pages: line 0 holds password, lap
+and epoch, the cursors follow in the next two. Two lines keep line 0 and
+the cursor line of an active download cached at the same time.
+
+? A line is marked valid only when its fill read returned I2C_OK. A failed
+fill leaves the line invalid and its status goes back to the caller, so
+0xFF or stale bytes are never served as the password, the log lap/epoch or
+a download cursor. A failed write-back leaves the line dirty.
+
+2 - Function Prototypes (Used in eep_cache.c)
+
+eep_cache_read(address, &data) ? Gives the byte from RAM; the bus is used only on a miss.
+eep_cache_write(address, data) ? Updates RAM and marks the line dirty, no bus access on a hit.
+                                 Both return the status of the fill read on a miss.
+eep_cache_flush()              ? Writes back every dirty line (use before power-sensitive steps),
+                                 returns I2C_OK or the first failed write.
+eep_cache_idle()               ? Called from the main loop, writes back one dirty line when the
+                                 EEPROM has finished its previous write cycle.
+*/
@@ -0,0 +1,299 @@
+/*
+ * File:   event_log.c
+
+ ? Step 28: Setting Up event_log.c (Circular Event Log Engine)
+This file (event_log.c) is responsible for:
+? Storing event records in a circular log in the external EEPROM.
+? Tagging each record with a sequence number so the log position survives a reset.
+? Recovering the newest/oldest record at boot without a full scan.
+ */
+
+#include "event_log.h"
+#include "ext_eep.h"
+#include "eep_cache.h"
+
+static unsigned short log_head;      // Slot the next record goes to
+static unsigned short log_used;      // Number of valid records
+static unsigned short log_lap;      // Current trip around the log
+static unsigned long log_epoch;     // First sequence number visible since the last clear
+static unsigned char log_ready;     // Head/lap recovered by log_init()
+
+#define SLOT_BUS_ERROR  3           // read_slot(): EEPROM did not answer, slot state unknown
+
+// Reads one slot: 0 = erased/torn/corrupt, 1 = lap bit 0, 2 = lap bit 1, SLOT_BUS_ERROR
+static unsigned char read_slot(unsigned short slot, log_entry_t *entry)
+{
+    unsigned char buf[LOG_SLOT_SIZE];
+    unsigned char lap;
+
+    // read_ext_eep_block() already retried through i2c_retry()
+    if (read_ext_eep_block(LOG_AREA_START + slot * LOG_SLOT_SIZE, buf, LOG_SLOT_SIZE) != I2C_OK)
+        return SLOT_BUS_ERROR;      // A bus error must never look like an empty slot
+    lap = log_record_lap(buf);
+
+    if (buf[LOG_COMMIT_OFFSET] != (LOG_COMMIT_MARK | lap))
+        return 0;                   // Never committed (power lost mid-write)
+    if (buf[LOG_CRC_OFFSET] != crc8(CRC8_INIT, buf, LOG_RECORD_SIZE))
+        return 0;                   // Torn or corrupted record
+    if (!log_record_unpack(buf, entry))
+        return 0;
+    return lap + 1;
+}
+
+static unsigned char slot_state(unsigned short slot)
+{
+    log_entry_t entry;
+
+    return read_slot(slot, &entry);
+}
+
+// Reads n big-endian config bytes through the cache, returns the I2C status
+static unsigned char read_config(unsigned short address, unsigned char n, unsigned long *value)
+{
+    unsigned char byte, status;
+
+    *value = 0;
+    while (n--)
+    {
+        status = eep_cache_read(address++, &byte);
+        if (status != I2C_OK)
+            return status;
+        *value = (*value << 8) | byte;
+    }
+    return I2C_OK;
+}
+
+// Writes n big-endian config bytes and flushes them, returns the I2C status
+static unsigned char write_config(unsigned short address, unsigned char n, unsigned long value)
+{
+    while (n--)
+    {
+        if (eep_cache_write(address++, value >> (8 * n)) != I2C_OK)
+            return I2C_ERR_BUS;
+    }
+    return eep_cache_flush();
+}
+
+// Stores value, or puts the old value back in the cache when the EEPROM fails
+static unsigned char store_config(unsigned short address, unsigned char n, unsigned long value,
+                                  unsigned long old)
+{
+    if (write_config(address, n, value) == I2C_OK)
+        return I2C_OK;
+    write_config(address, n, old);  // The dirty line must not carry the new value later
+    return I2C_ERR_BUS;
+}
+
+unsigned char log_init(void)
+{
+    unsigned char first, state;
+    unsigned short lo, hi, mid;
+    unsigned long value;
+
+    log_ready = 0;
+    log_head = 0;
+    log_used = 0;                   // Nothing visible until the position is known
+
+    if (read_config(LOG_LAP_ADDR, 2, &value) != I2C_OK)
+        return 0;                   // A failed read is not a fresh EEPROM
+    log_lap = (unsigned short)value;
+    if (log_lap == 0xFFFF)
+        log_lap = 0;                // Fresh EEPROM
+
+    if (read_config(LOG_EPOCH_ADDR, 4, &log_epoch) != I2C_OK)
+        return 0;
+    if (log_epoch == 0xFFFFFFFF)
+        log_epoch = 0;              // Never cleared
+
+    first = slot_state(0);
+    if (first == SLOT_BUS_ERROR)
+        return 0;
+    if (first == 0)
+    {
+        if (log_lap != 0)
+        {  // First record of a new lap was torn: the previous lap is still complete
+            log_lap--;
+            log_used = LOG_SLOTS - 1;
+        }  // else nothing written yet (or the very first record was torn)
+        log_ready = 1;
+        return 1;
+    }
+
+    // Power lost between the lap update and the first record of the new lap
+    if (first - 1 != (log_lap & 1))
+        log_lap--;
+
+    /* Slots 0..head-1 were written in the current lap. Find the first slot
+     * that is not: it is either erased (log not full yet) or still carries
+     * the previous lap bit (log has wrapped). */
+    lo = 1;
+    hi = LOG_SLOTS;
+    while (lo < hi)
+    {
+        mid = (lo + hi) / 2;
+        state = slot_state(mid);
+        if (state == SLOT_BUS_ERROR)
+            return 0;           // Guessing here would move the head onto live records
+        if (state == first)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+
+    if (lo == LOG_SLOTS || log_lap > 0)
+    {
+        state = slot_state(lo % LOG_SLOTS);
+        if (state == SLOT_BUS_ERROR)
+            return 0;
+        log_used = LOG_SLOTS;   // Wrapped: every slot holds a record
+        if (state == 0)
+            log_used--;         // Oldest record was torn by the last write
+    }
+    else
+        log_used = lo;
+    log_head = lo % LOG_SLOTS;
+    log_ready = 1;
+    return 1;
+}
+
+void log_append(const log_entry_t *entry)
+{
+    unsigned char buf[LOG_COMMIT_OFFSET];   // Everything but the commit marker
+    unsigned short address;
+
+    if (!log_ready && !log_init())
+        return;                 // Position unknown: drop the record, never overwrite one
+    address = LOG_AREA_START + log_head * LOG_SLOT_SIZE;
+
+    if (log_head == 0 && log_used != 0)
+    {
+        // Must reach the EEPROM before the first record of the lap
+        if (store_config(LOG_LAP_ADDR, 2, log_lap + 1, log_lap) != I2C_OK)
+            return;             // Not stored: a record of the new lap would be lost at boot
+        log_lap++;              // Starting a new trip around the log
+    }
+
+    log_record_pack(entry, log_lap & 1, buf);
+    buf[LOG_CRC_OFFSET] = crc8(CRC8_INIT, buf, LOG_RECORD_SIZE);
+    for (unsigned char n = LOG_CRC_OFFSET + 1; n < LOG_COMMIT_OFFSET; n++)
+        buf[n] = 0xFF;          // Unused bytes, same page write
+
+    // Record + CRC first, then the commit marker as a separate write cycle
+    write_ext_eep_block(address, buf, sizeof buf);
+    write_ext_eep(address + LOG_COMMIT_OFFSET, LOG_COMMIT_MARK | (log_lap & 1));
+
+    if (++log_head == LOG_SLOTS)
+        log_head = 0;
+    if (log_used < LOG_SLOTS)
+        log_used++;
+}
+
+// Sequence number the next record will get
+static unsigned long next_seq(void)
+{
+    if (log_head == 0 && log_used != 0)
+        return (unsigned long)(log_lap + 1) * LOG_SLOTS;  // Next record starts a new lap
+    return (unsigned long)log_lap * LOG_SLOTS + log_head;
+}
+
+unsigned short log_count(void)
+{
+    unsigned long since_clear = next_seq() - log_epoch;
+
+    // Only records written since the last clear are visible
+    return since_clear < log_used ? (unsigned short)since_clear : log_used;
+}
+
+static unsigned short record_slot(unsigned short n)
+{
+    // Oldest visible record is log_count() slots behind the head
+    return (log_head + LOG_SLOTS - log_count() + n) % LOG_SLOTS;
+}
+
+unsigned char log_read(unsigned short n, log_entry_t *entry)
+{
+    unsigned char state = read_slot(record_slot(n), entry);
+
+    return state != 0 && state != SLOT_BUS_ERROR;
+}
+
+unsigned long log_seq(unsigned short n)
+{
+    unsigned short slot = record_slot(n);
+    unsigned short lap = log_lap;
+
+    if (slot >= log_head && log_head != 0)
+        lap--;                  // Written during the previous lap
+    return (unsigned long)lap * LOG_SLOTS + slot;
+}
+
+void log_clear(void)
+{
+    if (!log_ready && !log_init())
+        return;                 // The epoch is taken from the head, which is unknown
+
+    // Start a new epoch: every record written so far becomes invisible
+    // One page write, old slots are reused as the log advances
+    unsigned long epoch = next_seq();
+    if (store_config(LOG_EPOCH_ADDR, 4, epoch, log_epoch) == I2C_OK)
+        log_epoch = epoch;      // Otherwise the old epoch is kept and the log stays as it was
+}
+
+/*
+ 1 - log_init() - Recover Log Position at Boot
+
+? Example with LOG_SLOTS = 8 after 11 records (log has wrapped once):
+
+Slot	0  1  2  3  4  5  6  7
+Lap bit	1  1  1  0  0  0  0  0
+
+Slots 0..2 carry the same lap bit as slot 0; slot 3 breaks the run, so the
+head is 3. The binary search needs about log2(LOG_SLOTS) 8-byte reads, so
+boot time grows only with the logarithm of the EEPROM size.
+
+? Torn writes: a record cut by a power loss has no valid commit marker and
+reads as an empty slot. If it was the first record of a lap (slot 0), the
+lap counter is stepped back and the previous lap is kept minus slot 0. If
+the log had wrapped, the slot at the head is checked once more and, when
+torn, is not counted. Either way the torn slot is simply the next one
+written, and recovery costs at most two extra slot reads.
+
+? Bus errors: read_ext_eep_block() retries a failed read I2C_RETRIES times
+(i2c_retry()). If it still fails, read_slot() returns SLOT_BUS_ERROR, which
+is never taken as an empty slot: log_init() stops, leaves no records
+visible and returns 0. log_append() and log_clear() run log_init() again
+first and drop their work while it fails, so a NACK or a stuck bus can
+never move the head backwards onto live records. The lap and epoch are read
+the same way (read_config()): a failed cache fill stops log_init() instead
+of being taken as a fresh EEPROM. store_config() keeps the old lap or epoch
+when the new one cannot be flushed, so the record or the clear is dropped.
+
+2 - log_append() - Store One Record
+
+? Packs the entry with the current lap bit, writes record and CRC into the
+head slot, then writes the commit marker and moves the head. When the log is full the oldest record is overwritten.
+The lap counter is written before the first record of a new lap, and
+log_init() detects (and undoes) a lap update whose record never made it.
+
+3 - log_read() / log_seq() - Read One Record
+
+? n = 0 is the oldest record, n = log_count() - 1 the newest.
+log_read() checks the commit marker and CRC and returns 0 for a bad slot.
+
+4 - log_clear() - Clear in O(1)
+
+? Instead of erasing every slot, log_clear() stores the sequence number the
+next record will get (the epoch) in the config area. Records with a lower
+sequence number are no longer counted by log_count(), so view_log() and
+download_log() do not see them. Their slots are simply overwritten as the
+log moves on, which costs no extra EEPROM writes.
+
+? Summary of event_log.c
+    Function                     Purpose
+log_init()              Finds head and record count from the lap bits, 0 on a bus error
+log_append(entry)       Appends a record to the circular log
+log_count()             Number of stored records
+log_read(n, entry)      Reads a record, oldest first
+log_seq(n)              Sequence number of a record
+log_clear()             Hides all records by starting a new epoch
+ */
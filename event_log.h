@@ -0,0 +1,75 @@
+/*
+ ? Step 27: Setting Up event_log.h (Circular Event Log Header File)
+This file (event_log.h) is needed to:
+? Define where and how event records are stored in the external EEPROM.
+? Declare the log engine functions used by save_log, view_log, download_log and clear_log.
+? Keep the log position in EEPROM so it survives a reset.
+*/
+
+#ifndef EVENT_LOG_H
+#define EVENT_LOG_H
+
+#include "ext_eep.h"
+#include "log_record.h"
+#include "crc8.h"
+#include "snapshot.h"
+
+// Log layout in external EEPROM
+#define LOG_SLOT_SIZE    8                  // Divides the page size, slots never straddle a page
+#define LOG_CRC_OFFSET   LOG_RECORD_SIZE    // CRC-8 of the packed record
+#define LOG_COMMIT_OFFSET (LOG_SLOT_SIZE - 1)  // Commit marker, written last
+#define LOG_COMMIT_MARK  0xA4               // Marker value, low bit = lap bit of the record
+#define LOG_AREA_START   0                  // First byte of the log area
+#define LOG_AREA_END     SNAP_AREA_START    // Snapshot region, then config, above the log
+#define LOG_SLOTS        ((unsigned short)((LOG_AREA_END - LOG_AREA_START) / LOG_SLOT_SIZE))
+#define LOG_LAP_ADDR     (EEP_CONFIG_START + 2)  // 2 bytes: number of times the log has wrapped
+#define LOG_EPOCH_ADDR   (EEP_CONFIG_START + 4)  // 4 bytes: first sequence number after the last clear
+
+// Function Prototypes
+unsigned char log_init(void);                          // Recover log head/tail at boot, 0 if the EEPROM did not answer
+void log_append(const log_entry_t *entry);             // Store one record
+unsigned short log_count(void);                        // Number of stored records
+unsigned char log_read(unsigned short n, log_entry_t *entry);  // Read record n (0 = oldest), 0 if invalid
+unsigned long log_seq(unsigned short n);               // Sequence number of record n
+void log_clear(void);                                  // Hide all records (new epoch)
+
+#endif
+
+/*
+ 1 - Slot Layout
+
+Byte	Content
+0..3	Packed record (see log_record.h)
+4	CRC-8 of bytes 0..3
+5..6	Unused, written as 0xFF with the record
+7	Commit marker: LOG_COMMIT_MARK | lap bit
+
+? A record is committed in two EEPROM writes: bytes 0..6 first, then the
+commit marker. A slot counts as valid only if the marker matches the lap
+bit of the record and the CRC matches, so a record whose write was cut by
+a power loss is never read back as data. The marker carries the lap bit
+so a marker left over from the previous trip around the log cannot
+validate a half-written new record.
+
+The sequence number of a record is not stored in the slot, it is derived
+from its position:
+
+seq = lap * LOG_SLOTS + slot
+
+? lap is kept at LOG_LAP_ADDR and rewritten once per trip around the log,
+so it wears exactly as fast as any log slot. Each record carries the low
+bit of its lap, which is all log_init() needs to find the head.
+
+? Slots are written strictly in order and wrap around, so every slot of the
+log area is written equally often (wear leveling across the whole area).
+
+2 - Function Prototypes (Used in event_log.c)
+
+log_init()         ? Finds the newest record by binary search over the lap bits and
+                     drops a torn record left by a power loss.
+log_append(entry)  ? Packs entry and writes it into the next slot.
+log_count()        ? Returns how many records are stored.
+log_read(n, entry) ? Reads and checks record n, counted from the oldest one.
+log_seq(n)         ? Returns the sequence number of record n.
+log_clear()        ? Starts a new epoch; older records become invisible.
+*/
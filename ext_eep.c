@@ -13,29 +13,164 @@ This file implements functions to communicate with an external EEPROM using I2C
  */
 #include "ext_eep.h"
 #include "i2c.h"
+#include "i2c_queue.h"
 
-void write_ext_eep(unsigned char address, unsigned char data) 
+static unsigned char write_pending;  // Set while the EEPROM may still be programming
+
+/* Start a transaction, address the EEPROM in write mode and send the word address.
+ * After a write the EEPROM ignores its address until the internal write
+ * cycle ends, so keep re-sending it until it is acknowledged (ACK polling).
+ * A failure is latched by i2c.c and reported by i2c_stop(). */
+static void ext_eep_begin(unsigned short address)
 {
-    i2c_start();                     // Start I2C communication
-    i2c_write(EEPROM_I2C_ADDRESS);    // Send EEPROM address with Write mode
-    i2c_write(address);               // Send memory register address
-    i2c_write(data);                  // Send data to be written
-    i2c_stop();                        // Stop I2C communication
+    unsigned short polls = EXT_EEP_ACK_POLLS;
+
+    i2c_set_speed(I2C_SSPADD(I2C_EEPROM_HZ));  // 24Cxx runs in fast mode
+    i2c_start();                          // Start I2C communication
+    i2c_write(EEPROM_I2C_ADDRESS);        // Send EEPROM address with Write mode
+    while (write_pending && i2c_status() == I2C_ERR_NACK && --polls)
+    {  // NACK: write cycle still running
+        i2c_stop();
+        i2c_start();
+        i2c_write(EEPROM_I2C_ADDRESS);
+    }
+    if (i2c_status() == I2C_OK)
+        write_pending = 0;
+
+#if EXT_EEP_ADDR_BYTES == 2
+    i2c_write(address >> 8);              // Word address, high byte
+#endif
+    i2c_write(address & 0xFF);            // Word address, low byte
 }
 
-unsigned char read_ext_eep(unsigned char address) 
+unsigned char ext_eep_write_done(void)
 {
-    unsigned char data;
+    if (write_pending)
+    {
+        i2c_set_speed(I2C_SSPADD(I2C_EEPROM_HZ));
+        i2c_start();                      // Probe the EEPROM once
+        i2c_write(EEPROM_I2C_ADDRESS);
+        if (i2c_stop() == I2C_OK)
+            write_pending = 0;            // ACK: write cycle finished
+    }
+    return !write_pending;
+}
 
-    i2c_start();                      // Start I2C communication
-    i2c_write(EEPROM_I2C_ADDRESS);    // Send EEPROM address with Write mode
-    i2c_write(address);               // Send memory register address
-    i2c_rep_start();                   // Restart I2C for reading
-    i2c_write(EEPROM_I2C_ADDRESS | 1); // Send EEPROM address with Read mode
-    data = i2c_read();                 // Read data from EEPROM
-    i2c_stop();                        // Stop I2C communication
+void ext_eep_wait_ready(void)
+{
+    unsigned short polls = EXT_EEP_ACK_POLLS;
 
-    return data;
+    while (!ext_eep_write_done() && --polls);
+}
+
+unsigned char write_ext_eep(unsigned short address, unsigned char data) 
+{
+    unsigned char status, tries = 0;
+
+    do
+    {
+        ext_eep_begin(address);       // Start I2C, address the EEPROM and the memory location
+        i2c_write(data);              // Send data to be written
+        status = i2c_stop();          // Stop I2C communication
+    } while (i2c_retry(I2C_DEV_EEPROM, status, &tries));
+
+    write_pending = 1;                // Internal write cycle starts now
+    return status;
+}
+
+unsigned char read_ext_eep(unsigned short address, unsigned char *data) 
+{
+    unsigned char status, tries = 0;
+
+    do
+    {
+        ext_eep_begin(address);       // Start I2C, address the EEPROM and the memory location
+        i2c_rep_start();              // Restart I2C for reading
+        i2c_write(EEPROM_I2C_ADDRESS | 1); // Send EEPROM address with Read mode
+        *data = i2c_read();           // Read data from EEPROM
+        i2c_nack();                   // Only one byte wanted
+        status = i2c_stop();          // Stop I2C communication
+    } while (i2c_retry(I2C_DEV_EEPROM, status, &tries));
+
+    return status;
+}
+
+unsigned char write_ext_eep_block(unsigned short address, const unsigned char *buf, unsigned char len)
+{
+    unsigned char chunk, status = I2C_OK, tries;
+
+    while (len && status == I2C_OK)
+    {
+        // Never cross a page boundary, the EEPROM would wrap inside the page
+        chunk = EXT_EEP_PAGE_SIZE - (address & (EXT_EEP_PAGE_SIZE - 1));
+        if (chunk > len)
+            chunk = len;
+
+        tries = 0;
+        do
+        {
+            ext_eep_begin(address);      // Waits for the previous page, if any
+            for (unsigned char n = 0; n < chunk; n++)
+            {
+                i2c_write(buf[n]);       // EEPROM auto-increments inside the page
+            }
+            status = i2c_stop();         // Starts one internal write cycle
+        } while (i2c_retry(I2C_DEV_EEPROM, status, &tries));
+        write_pending = 1;
+
+        address += chunk;
+        buf += chunk;
+        len -= chunk;
+    }
+    return status;
+}
+
+unsigned char read_ext_eep_block(unsigned short address, unsigned char *buf, unsigned char len)
+{
+    unsigned char status, tries = 0;
+
+    if (len == 0)
+        return I2C_OK;
+
+    do
+    {
+        ext_eep_begin(address);       // Start I2C, address the EEPROM and the first location
+        i2c_rep_start();              // Restart I2C for reading
+        i2c_write(EEPROM_I2C_ADDRESS | 1); // Send EEPROM address with Read mode
+        for (unsigned char n = 0; n < len - 1; n++)
+        {
+            buf[n] = i2c_read();      // EEPROM auto-increments across the whole array
+            i2c_ack();                // ACK asks for the next byte
+        }
+        buf[len - 1] = i2c_read();    // Last byte
+        i2c_nack();                   // NACK ends the sequential read
+        status = i2c_stop();          // Stop I2C communication
+    } while (i2c_retry(I2C_DEV_EEPROM, status, &tries));
+
+    return status;
+}
+
+unsigned char write_ext_eep_async(i2c_txn_t *txn, unsigned short address, const unsigned char *buf, unsigned char len)
+{
+    txn->addr = EEPROM_I2C_ADDRESS;
+    txn->sspadd = I2C_SSPADD(I2C_EEPROM_HZ);
+    txn->dev = I2C_DEV_EEPROM;
+#if EXT_EEP_ADDR_BYTES == 2
+    txn->cmd[0] = address >> 8;           // Word address, high byte
+    txn->cmd[1] = address & 0xFF;         // Word address, low byte
+    txn->cmd_len = 2;
+#else
+    txn->cmd[0] = address & 0xFF;
+    txn->cmd_len = 1;
+#endif
+    txn->tx = buf;
+    txn->tx_len = len;
+    txn->rx_len = 0;
+
+    if (!i2c_queue_submit(txn))
+        return 0;                         // Queue full
+    write_pending = 1;                    // Blocking accesses ACK-poll after it
+    return 1;
 }
 
 /*
@@ -93,8 +228,65 @@ Returns the retrieved data to the calling function.
 unsigned char stored_value = read_ext_eep(0x10);
 ? This reads the value stored at EEPROM address 0x10.
 
+3 - write_ext_eep_block() - Page Write to EEPROM
+
+? Writes len bytes starting at address in as few bus transactions as possible.
+
+The 24Cxx accepts up to one page (EXT_EEP_PAGE_SIZE bytes) after the word address
+and programs the whole page in a single ~5ms write cycle.
+Writes are split where they would cross a page boundary, because the chip
+wraps the address inside the page instead of moving to the next one.
+? Example Usage:
+
+unsigned char rec[5] = {0x12, 0x30, 0x45, 3, 0x40};
+write_ext_eep_block(0x00, rec, 5);  // One transaction, one write cycle
+
+4 - read_ext_eep_block() - Sequential Read from EEPROM
+
+? Reads len bytes starting at address with one start/address/restart sequence.
+
+After every byte the master sends ACK and the EEPROM returns the next address.
+The last byte is NACKed so the EEPROM releases SDA before the stop condition.
+Unlike page writes, sequential reads are not limited to one page.
+? Example Usage:
+
+unsigned char rec[5];
+read_ext_eep_block(0x00, rec, 5);  // Whole record in one transaction
+
+5 - ext_eep_write_done() / ext_eep_wait_ready() - Write Completion
+
+? After a stop condition the EEPROM spends up to 5ms programming and
+NACKs its own address until it is done (ACK polling).
+
+Every write sets write_pending; the next access re-sends the device
+address until it is acknowledged, so back-to-back writes run at the
+chip's real write speed instead of a fixed worst-case delay.
+ext_eep_write_done() probes once and returns at once (non-blocking).
+ext_eep_wait_ready() blocks until the last write cycle has finished.
+
+6 - write_ext_eep_async() - Queued Page Write
+
+? Fills txn with the word address and data and hands it to i2c_queue.c,
+then returns at once. buf must hold at most one page and must not change
+until txn->status is no longer pending. If the EEPROM is still programming
+it NACKs and the transaction ends with I2C_NACK; the caller retries later.
+Returns 0 if the queue was full and nothing was queued.
+
+7 - Status Codes and Retries
+
+? Every transfer returns the status from i2c_stop() (I2C_OK, I2C_ERR_NACK,
+I2C_ERR_TIMEOUT, I2C_ERR_BUS). A failed transaction is repeated up to
+I2C_RETRIES times through i2c_retry(), which counts it in
+i2c_stats[I2C_DEV_EEPROM]. ACK polling gives up after EXT_EEP_ACK_POLLS
+attempts, so even a missing EEPROM returns in bounded time.
+
 ? Summary of ext_eep.c
         Function                                      Purpose
 write_ext_eep(address, data)  ->      Stores data in EEPROM at a specific address
-read_ext_eep(address)         ->      Retrieves stored data from EEPROM*/
+read_ext_eep(address, &data)  ->      Retrieves stored data from EEPROM
+write_ext_eep_block(address, buf, len) -> Stores a block using page writes
+read_ext_eep_block(address, buf, len)  -> Reads a block in one sequential read
+ext_eep_write_done()          ->      Non-blocking check for end of write cycle
+ext_eep_wait_ready()          ->      Waits for the end of the write cycle
+write_ext_eep_async(txn, address, buf, len) -> Queues a page write, returns at once*/
 
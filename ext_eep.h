@@ -11,13 +11,55 @@ This file (ext_eep.h) is required to:
 #define EXT_EEP_H
 
 #include <xc.h>
+#include "i2c_queue.h"
 
 // EEPROM I2C Address
 #define EEPROM_I2C_ADDRESS  0xA0  // 10100000 (Write Mode)
 
-// Function Prototypes
-void write_ext_eep(unsigned char address, unsigned char data);  // Write data to EEPROM
-unsigned char read_ext_eep(unsigned char address);  // Read data from EEPROM
+// EEPROM Part Selection (size in kbit), override with -DEXT_EEP_KBIT=...
+#ifndef EXT_EEP_KBIT
+#define EXT_EEP_KBIT  2   // 24C02
+#endif
+
+// Address width and page size of the selected part
+#if EXT_EEP_KBIT <= 2
+#define EXT_EEP_ADDR_BYTES  1     // 24C01/24C02: one-byte word address
+#define EXT_EEP_PAGE_SIZE   8
+#define EXT_EEP_CONFIG_SIZE 56    // Keeps the password at 200
+#elif EXT_EEP_KBIT <= 16
+#error "24C04-24C16 use device address bits for paging and are not supported"
+#elif EXT_EEP_KBIT <= 64
+#define EXT_EEP_ADDR_BYTES  2     // 24C32/24C64: two-byte word address
+#define EXT_EEP_PAGE_SIZE   32
+#define EXT_EEP_CONFIG_SIZE 128
+#elif EXT_EEP_KBIT <= 256
+#define EXT_EEP_ADDR_BYTES  2     // 24C128/24C256
+#define EXT_EEP_PAGE_SIZE   64
+#define EXT_EEP_CONFIG_SIZE 128
+#elif EXT_EEP_KBIT <= 512
+#define EXT_EEP_ADDR_BYTES  2     // 24C512
+#define EXT_EEP_PAGE_SIZE   128
+#define EXT_EEP_CONFIG_SIZE 128
+#else
+#error "EXT_EEP_KBIT larger than 512 is not supported"
+#endif
+
+#define EXT_EEP_SIZE  ((unsigned long)EXT_EEP_KBIT * 128)  // Size in bytes
+
+// EEPROM Memory Map: log area from 0, snapshot region (snapshot.h), page-aligned config area at the top
+#define EEP_CONFIG_START   ((unsigned short)(EXT_EEP_SIZE - EXT_EEP_CONFIG_SIZE))  // 200 on a 24C02
+#define EEP_PASSWORD_ADDR  (EEP_CONFIG_START + 0)                 // 1 byte: password
+
+#define EXT_EEP_ACK_POLLS  400  // ACK polls before a write cycle counts as stuck (> 10ms at 400 kHz)
+
+// Function Prototypes (all transfers return an I2C_OK / I2C_ERR_* status, see i2c.h)
+unsigned char write_ext_eep(unsigned short address, unsigned char data);  // Write data to EEPROM
+unsigned char read_ext_eep(unsigned short address, unsigned char *data);  // Read data from EEPROM
+unsigned char write_ext_eep_block(unsigned short address, const unsigned char *buf, unsigned char len);  // Page write
+unsigned char read_ext_eep_block(unsigned short address, unsigned char *buf, unsigned char len);  // Sequential read
+unsigned char write_ext_eep_async(i2c_txn_t *txn, unsigned short address, const unsigned char *buf, unsigned char len);  // Queued page write, 0 if queue full
+unsigned char ext_eep_write_done(void);  // 1 when the last write cycle has finished (non-blocking)
+void ext_eep_wait_ready(void);           // Wait for the last write cycle to finish (ACK polling)
 
 #endif
 
@@ -31,7 +73,21 @@ unsigned char read_ext_eep(unsigned char address);  // Read data from EEPROM
 
 Ensures that the compiler only processes ext_eep.h once during compilation.
 
-2 - Define EEPROM I2C Address
+2 - Select the EEPROM Part
+
+#define EXT_EEP_KBIT  2   // 24C02
+? Selects the EEPROM size at compile time and derives from it:
+
+EXT_EEP_ADDR_BYTES ? 1 word-address byte for a 24C02, 2 for 24C32 and larger.
+EXT_EEP_PAGE_SIZE  ? Page size used by write_ext_eep_block().
+EXT_EEP_SIZE       ? Size in bytes; the config area (password, log metadata)
+                     sits in the top EXT_EEP_CONFIG_SIZE bytes (page aligned),
+                     the log uses everything below.
+
+All EEPROM addresses are 16-bit (unsigned short), so the same code runs on
+a 256-byte 24C02 and on a 64KB 24C512.
+
+3 - Define EEPROM I2C Address
 
 #define EEPROM_I2C_ADDRESS  0xA0  // 10100000 (Write Mode)
 ? Defines the I2C address for the external EEPROM.
@@ -51,10 +107,20 @@ unsigned char read_ext_eep(unsigned char address);  // Read data from EEPROM
 
 write_ext_eep(address, data) ? Stores data at the given address in EEPROM.
 read_ext_eep(address) ? Retrieves stored data from the specified address.
+write_ext_eep_block(address, buf, len) ? Stores len bytes starting at address using page writes.
+read_ext_eep_block(address, buf, len) ? Reads len bytes starting at address in one transaction.
+ext_eep_write_done() ? Returns 1 once the EEPROM has finished its internal write cycle.
+ext_eep_wait_ready() ? Polls the EEPROM until it acknowledges its address again.
+
+? Every transfer returns I2C_OK or an I2C_ERR_* code (see i2c.h). A failed
+transaction is retried I2C_RETRIES times and counted in
+i2c_stats[I2C_DEV_EEPROM]; ACK polling is bounded by EXT_EEP_ACK_POLLS.
 ? Example Usage:
 
 write_ext_eep(0x10, 0x55);  // Store value 0x55 at memory address 0x10
-unsigned char value = read_ext_eep(0x10);  // Read stored value from address 0x10
+unsigned char value;
+if (read_ext_eep(0x10, &value) == I2C_OK)  // Read stored value from address 0x10
+    ...
 ? This allows persistent storage for logs, passwords, and configurations.
 
 ? Summary of ext_eep.h
@@ -0,0 +1,162 @@
+/*
+ * File:   bbbench.cpp
+ *
+ * Throughput benchmark for the binary decoder.
+ * This file (bbbench.cpp) is responsible for:
+ * - Building a synthetic binary dump the way download_log.c sends it: header
+ *   frames, full record frames, resent frames and midnight rollovers.
+ * - Checking that crc8_fast() matches the firmware's crc8().
+ * - Timing decode_binary() + reconstruct_time() at 1, 2, 4 ... threads and
+ *   checking the decoded record count every run.
+ * - Printing the scaling: speedup over one thread and efficiency per thread.
+ *
+ * Usage: bbbench [MiB] [max threads]     (defaults: 256, all cores but at least 4)
+ */
+
+#include "bbdecode.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+
+using namespace bb;
+
+namespace {
+
+const unsigned kRecordsPerDownload = 1 << 20;   // A header every million records
+const unsigned kResendEvery = 101;              // About 1 % of frames sent twice
+
+void put_frame(std::vector<uint8_t> &out, uint8_t type, uint8_t number, const uint8_t *payload,
+               uint8_t len)
+{
+    size_t at = out.size();
+
+    out.push_back(DL_SOF);
+    out.push_back(type);
+    out.push_back(number);
+    out.push_back(len);
+    out.insert(out.end(), payload, payload + len);
+    out.push_back(crc8(CRC8_INIT, &out[at + 1], 3 + len));
+}
+
+void put_be32(uint8_t *p, uint32_t v)
+{
+    p[0] = v >> 24;
+    p[1] = v >> 16;
+    p[2] = v >> 8;
+    p[3] = v;
+}
+
+// Returns the number of records a correct decoder must produce
+uint64_t make_dump(size_t bytes, std::vector<uint8_t> &out)
+{
+    uint32_t seq = 0;
+    uint32_t seconds = 0;
+    uint32_t rng = 12345;
+    uint64_t records = 0;
+
+    out.clear();
+    out.reserve(bytes + DL_FRAME_MAX * 2);
+    while (out.size() < bytes) {
+        uint8_t header[DL_HEADER_LEN] = {DL_PROTO_VERSION, LOG_RECORD_SIZE, 0xFF, 0xFF};
+        uint8_t number = 0;
+
+        put_be32(header + 4, seq);
+        put_frame(out, DL_FRAME_HEADER, number++, header, DL_HEADER_LEN);
+
+        for (unsigned n = 0; n < kRecordsPerDownload && out.size() < bytes;
+             n += DL_RECORDS_PER_FRAME) {
+            uint8_t payload[4 + DL_RECORDS_PER_FRAME * LOG_RECORD_SIZE];
+
+            put_be32(payload, seq);
+            for (unsigned k = 0; k < DL_RECORDS_PER_FRAME; k++) {
+                log_entry_t e;
+
+                rng = rng * 1103515245 + 12345;
+                seconds = (seconds + 1 + (rng >> 24) * 8) % LOG_SECONDS_PER_DAY;  // A day every ~85 records
+                e.seconds = seconds;
+                e.event = (rng >> 8) % LOG_EVENT_COUNT;
+                e.speed = rng >> 16;
+                log_record_pack(&e, 0, payload + 4 + k * LOG_RECORD_SIZE);
+            }
+            put_frame(out, DL_FRAME_RECORDS, number, payload, sizeof payload);
+            if (rng % kResendEvery == 0)
+                put_frame(out, DL_FRAME_RECORDS, number, payload, sizeof payload);  // Lost ACK
+            number++;
+            seq += DL_RECORDS_PER_FRAME;
+            records += DL_RECORDS_PER_FRAME;
+        }
+        put_frame(out, DL_FRAME_END, number, nullptr, 0);
+    }
+    return records;
+}
+
+bool check_crc()
+{
+    uint8_t buf[257];
+    uint32_t rng = 1;
+
+    for (size_t i = 0; i < sizeof buf; i++) {
+        rng = rng * 1103515245 + 12345;
+        buf[i] = rng >> 16;
+    }
+    for (size_t len = 0; len <= 255; len++)
+        for (size_t off = 0; off < 2; off++)
+            if (crc8_fast(0x5A, buf + off, len) != crc8(0x5A, buf + off, len))
+                return false;
+    return true;
+}
+
+}  // namespace
+
+int main(int argc, char **argv)
+{
+    size_t mib = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 256;
+    unsigned max_threads = argc > 2 ? std::strtoul(argv[2], nullptr, 10)
+                                    : std::max(4u, std::thread::hardware_concurrency());
+
+    if (!mib || !max_threads) {
+        std::fputs("Usage: bbbench [MiB] [max threads]\n", stderr);
+        return 2;
+    }
+    if (!check_crc()) {
+        std::fputs("bbbench: crc8_fast() does not match crc8()\n", stderr);
+        return 1;
+    }
+
+    std::vector<uint8_t> data;
+    uint64_t records = make_dump(mib << 20, data);
+    std::printf("dump: %.1f MiB, %llu records, %u cores\n", data.size() / 1048576.0,
+                (unsigned long long)records, std::thread::hardware_concurrency());
+
+    Dump dump;  // Reused, so the runs time decoding and not page faults
+    bool ok = true;
+    double single = 0;
+    unsigned cores = std::max(1u, std::thread::hardware_concurrency());
+    std::printf("threads   time      GB/s   M records/s  speedup  efficiency\n");
+    for (unsigned threads = 1; threads <= max_threads; threads *= 2) {
+        double best = 1e30;
+
+        for (int run = 0; run < 5; run++) {
+            auto t0 = std::chrono::steady_clock::now();
+            decode_binary(data.data(), data.size(), dump, threads);
+            reconstruct_time(dump, 0);
+            std::chrono::duration<double> dt = std::chrono::steady_clock::now() - t0;
+            best = std::min(best, dt.count());
+
+            if (dump.size() != records || dump.stats.bad_frames || dump.stats.skipped_bytes) {
+                std::fprintf(stderr, "bbbench: %u threads decoded %zu records (%llu expected)\n",
+                             threads, dump.size(), (unsigned long long)records);
+                ok = false;
+            }
+        }
+        if (threads == 1)
+            single = best;
+        std::printf("%7u  %7.3f s  %6.2f  %12.1f  %6.2fx  %9.0f %%%s\n", threads, best,
+                    data.size() / best / 1e9, records / best / 1e6, single / best,
+                    single / best / threads * 100, threads > cores ? "  (more threads than cores)" : "");
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,119 @@
+/*
+ * File:   bbcheck.cpp
+ *
+ * Decoder regression check, run by "make check".
+ * This file (bbcheck.cpp) is responsible for:
+ * - Decoding every fixture in tests/ and comparing the CSV output with the
+ *   expected tests/<fixture>.csv.
+ * - Decoding the binary fixtures again at 2 to 8 threads with tiny spans, so
+ *   the thread split and the stitching must give the same CSV as one thread.
+ *
+ * Usage: bbcheck [fixture directory]     (default: tests)
+ */
+
+#include "bbdecode.h"
+
+#include <cerrno>
+#include <cstring>
+
+using namespace bb;
+
+namespace {
+
+// What each fixture covers
+const char *const kFixtures[] = {
+    "midnight.bin",     // Records on both sides of midnight
+    "resend.bin",       // A record frame sent twice (lost ACK)
+    "corrupt.bin",      // Line noise, a frame with a bad CRC and a stray SOF, then its resend
+    "two.bin",          // Two downloads in one file, the second starting at older records
+    "ascii.txt",        // Two "Logs from N:" dumps across midnight, CRC ERROR lines
+};
+
+const unsigned kMaxThreads = 8;
+
+bool read_file(const std::string &path, std::vector<uint8_t> &data)
+{
+    std::string error;
+
+    if (!read_input(path, InputOptions(), data, error)) {
+        std::fprintf(stderr, "bbcheck: %s\n", error.c_str());
+        return false;
+    }
+    return true;
+}
+
+std::string csv(const Dump &dump)
+{
+    char *buf = nullptr;
+    size_t len = 0;
+    std::FILE *out = open_memstream(&buf, &len);
+
+    if (!out)
+        return std::string();
+    write_csv(out, dump);
+    std::fclose(out);
+    std::string s(buf, len);
+    std::free(buf);
+    return s;
+}
+
+// First line where got and want differ, for the failure message
+std::string first_diff(const std::string &got, const std::string &want)
+{
+    size_t at = 0;
+
+    while (at < got.size() && at < want.size() && got[at] == want[at])
+        at++;
+    size_t line = want.rfind('\n', at == 0 ? 0 : at - 1);
+    line = line == std::string::npos ? 0 : line + 1;
+    size_t eol = want.find('\n', line);
+    return "expected \"" + want.substr(line, eol == std::string::npos ? eol : eol - line) + "\"";
+}
+
+bool check(const std::string &dir, const char *name)
+{
+    std::vector<uint8_t> input, expected;
+
+    if (!read_file(dir + "/" + name, input) || !read_file(dir + "/" + name + ".csv", expected))
+        return false;
+    std::string want(expected.begin(), expected.end());
+
+    bool binary = detect_format(input.data(), input.size()) == Format::Binary;
+    unsigned runs = binary ? kMaxThreads : 1;
+    bool ok = true;
+    for (unsigned threads = 1; threads <= runs; threads++) {
+        Dump dump;
+
+        if (binary)
+            decode_binary(input.data(), input.size(), dump, threads, 1);  // Spans of a few bytes
+        else
+            decode_ascii(input.data(), input.size(), dump);
+        reconstruct_time(dump, 0);
+
+        std::string got = csv(dump);
+        if (got != want) {
+            std::fprintf(stderr, "bbcheck: %s at %u thread%s: %s\n", name, threads,
+                         threads == 1 ? "" : "s", first_diff(got, want).c_str());
+            ok = false;
+        }
+    }
+    std::printf("%-14s %s\n", name, ok ? "ok" : "FAILED");
+    return ok;
+}
+
+}  // namespace
+
+int main(int argc, char **argv)
+{
+    std::string dir = argc > 1 ? argv[1] : "tests";
+    unsigned failed = 0;
+
+    for (const char *name : kFixtures)
+        failed += !check(dir, name);
+    if (failed) {
+        std::fprintf(stderr, "bbcheck: %u of %zu fixtures failed\n", failed,
+                     sizeof kFixtures / sizeof kFixtures[0]);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,238 @@
+/*
+ * File:   bbdecode.cpp
+ *
+ * Command line decoder for Car Black Box log dumps.
+ * This file (bbdecode.cpp) is responsible for:
+ * - Reading a dump (file, pipe, serial port or pty) and detecting its format.
+ * - Decoding, rebuilding timestamps and writing CSV, JSON Lines or columnar output.
+ *
+ * Usage: bbdecode [options] [INPUT]      (INPUT defaults to "-", stdin)
+ */
+
+#include "bbdecode.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <getopt.h>
+#include <thread>
+
+using namespace bb;
+
+static void usage(std::FILE *out)
+{
+    std::fputs(
+        "Usage: bbdecode [options] [INPUT]\n"
+        "Decodes a Car Black Box log dump (ASCII or binary) from a file, \"-\" (stdin),\n"
+        "a serial port or a pty.\n"
+        "\n"
+        "  -f, --format auto|ascii|binary  Input format (default auto)\n"
+        "  -t, --to csv|jsonl|columnar     Output format (default csv)\n"
+        "  -o, --output FILE               Output file (default stdout)\n"
+        "  -d, --date YYYY-MM-DD           Date of the first record (UTC), gives dated timestamps\n"
+        "  -j, --threads N                 Decoder threads (default: all cores)\n"
+        "  -b, --baud RATE                 Serial port baud rate (default 9600)\n"
+        "      --idle-ms MS                A serial read ends after MS without data (default 2000)\n"
+        "      --pull all|HOST             Start a binary download on the device and ACK its\n"
+        "                                  frames: all records, or new records of HOST (0..3)\n"
+        "  -s, --stats                     Print decoder counters to stderr\n"
+        "  -h, --help\n",
+        out);
+}
+
+// Unix time of midnight (UTC) of a YYYY-MM-DD date, false if malformed
+static bool parse_date(const char *s, int64_t &t)
+{
+    int y, m, d;
+    char tail;
+
+    if (std::sscanf(s, "%4d-%2d-%2d%c", &y, &m, &d, &tail) != 3 || m < 1 || m > 12 || d < 1 || d > 31)
+        return false;
+    y -= m <= 2;
+    int64_t era = (y >= 0 ? y : y - 399) / 400;
+    unsigned yoe = (unsigned)(y - era * 400);
+    unsigned doy = (153 * (m > 2 ? m - 3 : m + 9) + 2) / 5 + d - 1;
+    unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    t = (era * 146097 + doe - 719468) * 86400;
+    return true;
+}
+
+static bool parse_uint(const char *s, unsigned long max, unsigned long &v)
+{
+    char *end;
+
+    errno = 0;
+    v = std::strtoul(s, &end, 10);
+    return *s && !*end && !errno && v <= max;
+}
+
+static void print_stats(const Dump &dump)
+{
+    const Stats &s = dump.stats;
+
+    std::fprintf(stderr,
+                 "records %zu, frames %llu, headers %llu, telemetry %llu, bad frames %llu, "
+                 "skipped bytes %llu, bad records %llu, duplicates %llu, rollovers %llu",
+                 dump.size(), (unsigned long long)s.frames, (unsigned long long)s.headers,
+                 (unsigned long long)s.telemetry, (unsigned long long)s.bad_frames,
+                 (unsigned long long)s.skipped_bytes, (unsigned long long)s.bad_records,
+                 (unsigned long long)s.duplicates, (unsigned long long)s.rollovers);
+    if (s.expected)
+        std::fprintf(stderr, ", announced %llu", (unsigned long long)s.expected);
+    std::fputc('\n', stderr);
+}
+
+int main(int argc, char **argv)
+{
+    enum { OPT_IDLE = 256, OPT_PULL };
+    static const struct option longopts[] = {
+        {"format", required_argument, nullptr, 'f'},
+        {"to", required_argument, nullptr, 't'},
+        {"output", required_argument, nullptr, 'o'},
+        {"date", required_argument, nullptr, 'd'},
+        {"threads", required_argument, nullptr, 'j'},
+        {"baud", required_argument, nullptr, 'b'},
+        {"idle-ms", required_argument, nullptr, OPT_IDLE},
+        {"pull", required_argument, nullptr, OPT_PULL},
+        {"stats", no_argument, nullptr, 's'},
+        {"help", no_argument, nullptr, 'h'},
+        {nullptr, 0, nullptr, 0},
+    };
+    Format format = Format::Auto;
+    Output to = Output::Csv;
+    const char *output = nullptr;
+    int64_t base = 0;
+    unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+    InputOptions in;
+    bool stats = false;
+    unsigned long v;
+    int c;
+
+    while ((c = getopt_long(argc, argv, "f:t:o:d:j:b:sh", longopts, nullptr)) != -1) {
+        switch (c) {
+        case 'f':
+            if (!std::strcmp(optarg, "auto"))
+                format = Format::Auto;
+            else if (!std::strcmp(optarg, "ascii"))
+                format = Format::Ascii;
+            else if (!std::strcmp(optarg, "binary"))
+                format = Format::Binary;
+            else {
+                std::fprintf(stderr, "bbdecode: unknown input format '%s'\n", optarg);
+                return 2;
+            }
+            break;
+        case 't':
+            if (!std::strcmp(optarg, "csv"))
+                to = Output::Csv;
+            else if (!std::strcmp(optarg, "jsonl"))
+                to = Output::Jsonl;
+            else if (!std::strcmp(optarg, "columnar"))
+                to = Output::Columnar;
+            else {
+                std::fprintf(stderr, "bbdecode: unknown output format '%s'\n", optarg);
+                return 2;
+            }
+            break;
+        case 'o':
+            output = optarg;
+            break;
+        case 'd':
+            if (!parse_date(optarg, base)) {
+                std::fprintf(stderr, "bbdecode: bad date '%s' (YYYY-MM-DD)\n", optarg);
+                return 2;
+            }
+            break;
+        case 'j':
+            if (!parse_uint(optarg, 256, v) || !v) {
+                std::fprintf(stderr, "bbdecode: bad thread count '%s'\n", optarg);
+                return 2;
+            }
+            threads = v;
+            break;
+        case 'b':
+            if (!parse_uint(optarg, 115200, v)) {
+                std::fprintf(stderr, "bbdecode: bad baud rate '%s'\n", optarg);
+                return 2;
+            }
+            in.baud = v;
+            break;
+        case OPT_IDLE:
+            if (!parse_uint(optarg, 600000, v) || !v) {
+                std::fprintf(stderr, "bbdecode: bad idle time '%s'\n", optarg);
+                return 2;
+            }
+            in.idle_ms = v;
+            break;
+        case OPT_PULL:
+            if (!std::strcmp(optarg, "all"))
+                in.pull_host = DL_NO_HOST;
+            else if (parse_uint(optarg, DL_HOSTS - 1, v))
+                in.pull_host = v;
+            else {
+                std::fprintf(stderr, "bbdecode: --pull takes 'all' or a host number 0..%d\n",
+                             DL_HOSTS - 1);
+                return 2;
+            }
+            break;
+        case 's':
+            stats = true;
+            break;
+        case 'h':
+            usage(stdout);
+            return 0;
+        default:
+            usage(stderr);
+            return 2;
+        }
+    }
+    if (argc - optind > 1) {
+        usage(stderr);
+        return 2;
+    }
+    std::string path = optind < argc ? argv[optind] : "-";
+
+    std::vector<uint8_t> data;
+    std::string error;
+    if (!read_input(path, in, data, error)) {
+        std::fprintf(stderr, "bbdecode: %s\n", error.c_str());
+        return 1;
+    }
+
+    if (format == Format::Auto)
+        format = in.pull_host >= 0 ? Format::Binary : detect_format(data.data(), data.size());
+
+    Dump dump;
+    if (format == Format::Binary)
+        decode_binary(data.data(), data.size(), dump, threads);
+    else
+        decode_ascii(data.data(), data.size(), dump);
+    std::vector<uint8_t>().swap(data);
+    reconstruct_time(dump, base);
+
+    std::FILE *out = stdout;
+    if (output && !(out = std::fopen(output, "wb"))) {
+        std::fprintf(stderr, "bbdecode: %s: %s\n", output, std::strerror(errno));
+        return 1;
+    }
+    switch (to) {
+    case Output::Csv:
+        write_csv(out, dump);
+        break;
+    case Output::Jsonl:
+        write_jsonl(out, dump);
+        break;
+    case Output::Columnar:
+        write_columnar(out, dump);
+        break;
+    }
+    if (std::fflush(out) != 0 || std::ferror(out) || (out != stdout && std::fclose(out) != 0)) {
+        std::fprintf(stderr, "bbdecode: write error: %s\n", std::strerror(errno));
+        return 1;
+    }
+
+    if (stats)
+        print_stats(dump);
+    return 0;
+}
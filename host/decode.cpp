@@ -0,0 +1,468 @@
+/*
+ * File:   decode.cpp
+ *
+ * This file (decode.cpp) is responsible for:
+ * - Finding and checking binary download frames (download_log.h) in a byte stream.
+ * - Unpacking their records with the firmware's log_record_unpack().
+ * - Parsing the ASCII dump and rebuilding absolute timestamps across midnight.
+ */
+
+#include "bbdecode.h"
+
+#include <algorithm>
+#include <cstring>
+#include <thread>
+
+namespace bb {
+
+const char *const event_names[LOG_EVENT_COUNT] = {
+    "ON", "GN", "GR", "G1", "G2", "G3", "G4", "C", "DL", "CL"
+};
+
+void Columns::resize(size_t n)
+{
+    seq.resize(n);
+    seconds.resize(n);
+    event.resize(n);
+    speed.resize(n);
+}
+
+void Stats::add(const Stats &s)
+{
+    frames += s.frames;
+    headers += s.headers;
+    telemetry += s.telemetry;
+    bad_frames += s.bad_frames;
+    skipped_bytes += s.skipped_bytes;
+    bad_records += s.bad_records;
+    duplicates += s.duplicates;
+    rollovers += s.rollovers;
+    expected += s.expected;
+}
+
+size_t Dump::size() const
+{
+    size_t n = 0;
+    for (const Columns &c : parts)
+        n += c.size();
+    return n;
+}
+
+// Slicing tables: crc8_tables[k][b] is the CRC of byte b followed by k zero bytes
+static struct Crc8Tables {
+    uint8_t t[16][256];
+
+    Crc8Tables()
+    {
+        for (unsigned b = 0; b < 256; b++) {
+            unsigned char byte = b;
+            t[0][b] = crc8(CRC8_INIT, &byte, 1);  // The firmware's own table
+        }
+        for (unsigned k = 1; k < 16; k++)
+            for (unsigned b = 0; b < 256; b++)
+                t[k][b] = t[0][t[k - 1][b]];
+    }
+} crc8_tables;
+
+uint8_t crc8_fast(uint8_t crc, const uint8_t *buf, size_t len)
+{
+    const auto &t = crc8_tables.t;
+
+    // The CRC is linear: sixteen independent lookups replace sixteen dependent
+    // ones, so a 24-byte record frame is two steps deep
+    for (; len >= 16; len -= 16, buf += 16) {
+        crc = t[15][crc ^ buf[0]] ^ t[14][buf[1]] ^ t[13][buf[2]] ^ t[12][buf[3]]
+            ^ t[11][buf[4]] ^ t[10][buf[5]] ^ t[9][buf[6]] ^ t[8][buf[7]]
+            ^ t[7][buf[8]] ^ t[6][buf[9]] ^ t[5][buf[10]] ^ t[4][buf[11]]
+            ^ t[3][buf[12]] ^ t[2][buf[13]] ^ t[1][buf[14]] ^ t[0][buf[15]];
+    }
+    if (len >= 8) {
+        crc = t[7][crc ^ buf[0]] ^ t[6][buf[1]] ^ t[5][buf[2]] ^ t[4][buf[3]]
+            ^ t[3][buf[4]] ^ t[2][buf[5]] ^ t[1][buf[6]] ^ t[0][buf[7]];
+        len -= 8;
+        buf += 8;
+    }
+    while (len--)
+        crc = t[0][crc ^ *buf++];
+    return crc;
+}
+
+static inline uint32_t be32(const uint8_t *p)
+{
+    return (uint32_t)p[0] << 24 | (uint32_t)p[1] << 16 | (uint32_t)p[2] << 8 | p[3];
+}
+
+// Length of a valid frame starting at p, 0 if there is none
+static inline size_t frame_at(const uint8_t *p, const uint8_t *end)
+{
+    if (end - p < DL_FRAME_OVERHEAD || p[0] != DL_SOF)
+        return 0;
+
+    unsigned len = p[3];
+    switch (p[1]) {
+    case DL_FRAME_RECORDS:
+        if (len < 4 + LOG_RECORD_SIZE || len > 4 + DL_RECORDS_PER_FRAME * LOG_RECORD_SIZE
+            || (len - 4) % LOG_RECORD_SIZE)
+            return 0;
+        break;
+    case DL_FRAME_HEADER:
+        if (len != DL_HEADER_LEN)
+            return 0;
+        break;
+    case DL_FRAME_END:
+        if (len != 0)
+            return 0;
+        break;
+    case TM_FRAME_TELEMETRY:
+        if (len != TM_PAYLOAD_LEN)
+            return 0;
+        break;
+    default:
+        return 0;
+    }
+
+    size_t n = DL_FRAME_OVERHEAD + len;
+    if ((size_t)(end - p) < n)
+        return 0;
+    // CRC over type..payload followed by the CRC byte itself is 0 for a good frame
+    return crc8_fast(CRC8_INIT, p + 1, n - 1) == 0 ? n : 0;
+}
+
+size_t frame_length(const uint8_t *p, const uint8_t *end)
+{
+    return frame_at(p, end);
+}
+
+// One thread's share of a binary dump
+struct Span {
+    size_t start = 0;
+    size_t stop = 0;            // Frames starting before this offset belong to the span
+    size_t first = SIZE_MAX;    // Offset of the first frame decoded
+    size_t next = 0;            // Offset after the last frame (where the next span must go on)
+    bool end_synced = false;    // The last step ended on a frame boundary
+    bool seq_known = false;     // expect is valid
+    uint64_t expect = 0;        // One more than the highest sequence number taken
+    Stats stats;
+};
+
+static void decode_span(const uint8_t *buf, size_t len, Span &span, bool synced, bool counting,
+                        Columns &cols)
+{
+    const uint8_t *p = buf + span.start;
+    const uint8_t *end = buf + len;
+    const uint8_t *limit = buf + span.stop;
+    Stats &st = span.stats;
+    uint64_t expect = 0;
+    bool known = false;
+
+    // Columns are written through pointers and trimmed at the end; a reused
+    // Dump already has the room, so nothing is cleared or zeroed per run
+    size_t cap = (span.stop - span.start) / 6 + 16;    // 6.25 bytes per record at best
+    size_t n_rec = 0;
+    int64_t day = 0;                // Midnights since the first record of the span
+    uint32_t last = 0;
+    if (cols.size() < cap)
+        cols.resize(cap);
+    uint32_t *o_seq = cols.seq.data();
+    uint32_t *o_sec = cols.seconds.data();
+    uint8_t *o_ev = cols.event.data();
+    uint8_t *o_sp = cols.speed.data();
+
+    span.first = SIZE_MAX;
+    st = Stats();
+
+    while (p < limit) {
+        size_t n = frame_at(p, end);
+
+        if (n && !synced) {
+            // Regaining sync: a random 0xA5 must not pass, the next frame has to check out too
+            const uint8_t *q = p + n;
+            if (q != end && !frame_at(q, end))
+                n = 0;
+        }
+        if (!n) {
+            if (synced)
+                st.bad_frames++;        // A frame was due here
+            synced = false;
+            const void *sof = std::memchr(p + 1, DL_SOF, limit - p - 1);
+            const uint8_t *q = sof ? (const uint8_t *)sof : limit;
+            if (counting)
+                st.skipped_bytes += q - p;
+            p = q;
+            continue;
+        }
+
+        synced = counting = true;
+        if (span.first == SIZE_MAX)
+            span.first = p - buf;
+        st.frames++;
+
+        const uint8_t *pl = p + 4;      // Payload
+        switch (p[1]) {
+        case DL_FRAME_RECORDS: {
+            uint32_t seq = be32(pl);
+            unsigned count = (p[3] - 4) / LOG_RECORD_SIZE;
+            const uint8_t *rec = pl + 4;
+
+            if (n_rec + DL_RECORDS_PER_FRAME > cap) {
+                cap *= 2;               // Only after a resync moved the span back
+                cols.resize(cap);
+                o_seq = cols.seq.data();
+                o_sec = cols.seconds.data();
+                o_ev = cols.event.data();
+                o_sp = cols.speed.data();
+            }
+            unsigned k = 0;
+            if (known && seq < expect) {
+                // Frame sent again, the host's ACK was lost: skip what was already taken
+                k = (unsigned)std::min<uint64_t>(count, expect - seq);
+                st.duplicates += k;
+                seq += k;
+                rec += k * LOG_RECORD_SIZE;
+            }
+            if (k < count) {
+                expect = (uint64_t)seq + (count - k);
+                known = true;
+            }
+            for (; k < count; k++, seq++, rec += LOG_RECORD_SIZE) {
+                log_entry_t entry;
+
+                if (!log_record_unpack(rec, &entry)) {
+                    st.bad_records++;   // Slot failed its CRC on the device
+                    continue;
+                }
+                uint32_t sec = (uint32_t)entry.seconds;
+                day += n_rec && sec < last;
+                last = sec;
+                o_seq[n_rec] = seq;
+                o_sec[n_rec] = sec;
+                o_ev[n_rec] = entry.event;
+                o_sp[n_rec] = entry.speed;
+                n_rec++;
+            }
+            break;
+        }
+        case DL_FRAME_HEADER:
+            st.headers++;
+            if (pl[0] != DL_PROTO_VERSION || pl[1] != LOG_RECORD_SIZE) {
+                st.bad_frames++;        // Newer firmware, records would be misread
+                break;
+            }
+            st.expected += (unsigned)pl[2] << 8 | pl[3];
+            // expect is kept: a new download that starts at older records
+            // (a repeated pull, pulls appended to one file) only adds the newer ones
+            break;
+        case TM_FRAME_TELEMETRY:
+            st.telemetry++;
+            break;
+        default:                        // DL_FRAME_END
+            break;
+        }
+        p += n;
+    }
+
+    span.next = p - buf;
+    span.end_synced = synced;
+    span.seq_known = known;
+    span.expect = expect;
+    cols.resize(n_rec);
+    cols.days = day;
+}
+
+// Midnights inside a part (Columns::days)
+static void count_days(Columns &cols)
+{
+    int64_t day = 0;
+
+    for (size_t i = 1; i < cols.size(); i++)
+        day += cols.seconds[i] < cols.seconds[i - 1];
+    cols.days = day;
+}
+
+// Drops the first n records of a part
+static void drop_front(Columns &cols, size_t n)
+{
+    cols.seq.erase(cols.seq.begin(), cols.seq.begin() + n);
+    cols.seconds.erase(cols.seconds.begin(), cols.seconds.begin() + n);
+    cols.event.erase(cols.event.begin(), cols.event.begin() + n);
+    cols.speed.erase(cols.speed.begin(), cols.speed.begin() + n);
+    count_days(cols);           // A midnight may have been among them
+}
+
+void decode_binary(const uint8_t *buf, size_t len, Dump &dump, unsigned threads, size_t min_span)
+{
+    if (threads < 1)
+        threads = 1;
+    if (min_span < 1)
+        min_span = 1;
+    if (len / threads < min_span)
+        threads = std::max<size_t>(1, len / min_span);
+
+    std::vector<Span> spans(threads);
+    dump.parts.resize(threads);
+    for (unsigned k = 0; k < threads; k++) {
+        spans[k].start = len / threads * k;
+        spans[k].stop = k + 1 == threads ? len : len / threads * (k + 1);
+    }
+
+    std::vector<std::thread> pool;
+    for (unsigned k = 1; k < threads; k++)
+        pool.emplace_back([&, k] { decode_span(buf, len, spans[k], false, false, dump.parts[k]); });
+    decode_span(buf, len, spans[0], false, true, dump.parts[0]);
+    for (std::thread &t : pool)
+        t.join();
+
+    // Stitch: every span must go on exactly where the one before stopped
+    dump.stats = Stats();
+    bool known = false;
+    uint64_t expect = 0;
+    for (unsigned k = 0; k < threads; k++) {
+        Span &s = spans[k];
+        if (k > 0) {
+            const Span &prev = spans[k - 1];
+            bool same_state = !prev.end_synced && prev.next == s.start;
+
+            if (same_state)
+                s.stats.skipped_bytes += (s.first == SIZE_MAX ? s.stop : s.first) - s.start;
+            else if (s.first != prev.next) {
+                // False sync, or the previous span's last frame reached past ours
+                s.start = std::min(prev.next, s.stop);
+                decode_span(buf, len, s, prev.end_synced, true, dump.parts[k]);
+            }
+        }
+
+        // The records a part keeps rise strictly by sequence number, so the ones
+        // an earlier part already has are a prefix
+        Columns &c = dump.parts[k];
+        size_t dup = 0;
+        while (known && dup < c.size() && c.seq[dup] < expect)
+            dup++;
+        if (dup) {
+            drop_front(c, dup);
+            s.stats.duplicates += dup;
+        }
+        if (s.seq_known)
+            expect = known ? std::max(expect, s.expect) : s.expect;
+        known |= s.seq_known;
+        dump.stats.add(s.stats);
+    }
+}
+
+void decode_ascii(const uint8_t *buf, size_t len, Dump &dump)
+{
+    const char *p = (const char *)buf;
+    const char *end = p + len;
+    uint64_t base = 0;
+    bool numbered = false;              // Line numbers are sequence numbers ("Logs from N:")
+    bool known = false;
+    uint64_t expect = 0;                // One more than the highest sequence number taken
+
+    dump.parts.assign(1, Columns());
+    dump.stats = Stats();
+    Columns &cols = dump.parts[0];
+
+    while (p < end) {
+        const char *eol = (const char *)std::memchr(p, '\n', end - p);
+        const char *line = p;
+        const char *stop = eol ? eol : end;
+        p = eol ? eol + 1 : end;
+
+        while (line < stop && (*line == '\r' || *line == ' '))
+            line++;                     // Lines end in "\n\r", the '\r' leads the next one
+        while (stop > line && (stop[-1] == '\r' || stop[-1] == ' '))
+            stop--;
+        std::string s(line, stop);
+
+        if (s.compare(0, 9, "Logs from") == 0) {
+            base = std::strtoull(s.c_str() + 9, nullptr, 10);  // "Logs from N:"
+            numbered = true;            // expect is kept, as for binary header frames
+            dump.stats.headers++;
+            continue;
+        }
+        if (s == "Logs:") {             // Firmware before the download cursor
+            base = 0;
+            numbered = known = false;   // Positions, not sequence numbers: nothing to match
+            dump.stats.headers++;
+            continue;
+        }
+        if (s.empty() || s[0] < '0' || s[0] > '9')
+            continue;                   // Column titles, I2C counters, console replies
+
+        // "<n> HH:MM:SS <EV> <SPEED>" or "<n> CRC ERROR"
+        char *rest;
+        uint64_t n = std::strtoull(s.c_str(), &rest, 10);
+        unsigned h, m, sec, speed;
+        char ev[3] = {0};
+        int used = 0;
+
+        if (std::strncmp(rest, " CRC ERROR", 10) == 0
+            || std::sscanf(rest, " %2u:%2u:%2u %n", &h, &m, &sec, &used) != 3
+            || h > 23 || m > 59 || sec > 59) {
+            dump.stats.bad_records++;
+            continue;
+        }
+        rest += used;
+        ev[0] = rest[0];
+        ev[1] = rest[0] && rest[1] != ' ' ? rest[1] : '\0';  // "C " is printed with a space
+
+        unsigned code = 0;
+        while (code < LOG_EVENT_COUNT && std::strcmp(ev, event_names[code]) != 0)
+            code++;
+        if (code == LOG_EVENT_COUNT || std::sscanf(rest + 2, " %u", &speed) != 1 || speed > 255) {
+            dump.stats.bad_records++;
+            continue;
+        }
+
+        if (numbered) {
+            if (known && base + n < expect) {
+                dump.stats.duplicates++;    // Already taken from an earlier dump in the file
+                continue;
+            }
+            expect = base + n + 1;
+            known = true;
+        }
+        cols.seq.push_back((uint32_t)(base + n));
+        cols.seconds.push_back(h * 3600 + m * 60 + sec);
+        cols.event.push_back(code);
+        cols.speed.push_back(speed);
+    }
+    count_days(cols);
+}
+
+Format detect_format(const uint8_t *buf, size_t len)
+{
+    const uint8_t *end = buf + len;
+    const uint8_t *text = (const uint8_t *)memmem(buf, len, "Logs", 4);
+
+    for (const uint8_t *p = buf; p < end && (!text || p < text); p++) {
+        size_t n = frame_at(p, end);
+        if (n && (p + n == end || frame_at(p + n, end)))
+            return Format::Binary;
+    }
+    return Format::Ascii;
+}
+
+void reconstruct_time(Dump &dump, int64_t base)
+{
+    dump.base = base;
+
+    // The decoders count the midnights inside each part, only the ones between parts are left
+    int64_t day = 0;
+    bool have_last = false;
+    uint32_t last = 0;
+    for (Columns &c : dump.parts) {
+        if (c.size() == 0) {
+            c.midnight = base + day * (int64_t)LOG_SECONDS_PER_DAY;
+            continue;                   // Empty parts carry the last second over
+        }
+        if (have_last && c.seconds.front() < last)
+            day++;
+        c.midnight = base + day * (int64_t)LOG_SECONDS_PER_DAY;
+        day += c.days;
+        last = c.seconds.back();
+        have_last = true;
+    }
+    dump.stats.rollovers = day;
+}
+
+}  // namespace bb
@@ -0,0 +1,229 @@
+/*
+ * File:   input.cpp
+ *
+ * This file (input.cpp) is responsible for:
+ * - Reading a dump from a file, a pipe (stdin) or a serial port / pty.
+ * - Setting a tty to raw mode at the device's baud rate.
+ * - Pulling a binary download live: sending 'B' or 'I'+host and answering
+ *   every frame with ACK/NAK and its frame number (download_log.h), as the
+ *   device expects.
+ */
+
+#include "bbdecode.h"
+
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <unistd.h>
+
+namespace bb {
+
+namespace {
+
+bool read_all(int fd, std::vector<uint8_t> &data, std::string &error)
+{
+    uint8_t chunk[1 << 16];
+
+    for (;;) {
+        ssize_t n = read(fd, chunk, sizeof chunk);
+        if (n > 0)
+            data.insert(data.end(), chunk, chunk + n);
+        else if (n == 0)
+            return true;
+        else if (errno != EINTR) {
+            error = std::strerror(errno);
+            return false;
+        }
+    }
+}
+
+bool set_raw(int fd, unsigned baud, std::string &error)
+{
+    static const struct { unsigned baud; speed_t code; } rates[] = {
+        {9600, B9600}, {19200, B19200}, {38400, B38400}, {57600, B57600}, {115200, B115200},
+    };
+    struct termios tio;
+
+    if (tcgetattr(fd, &tio) != 0) {
+        error = std::strerror(errno);
+        return false;
+    }
+    cfmakeraw(&tio);
+    tio.c_cc[VMIN] = 0;
+    tio.c_cc[VTIME] = 0;
+    for (const auto &r : rates) {
+        if (r.baud == baud) {
+            cfsetispeed(&tio, r.code);
+            cfsetospeed(&tio, r.code);
+            if (tcsetattr(fd, TCSANOW, &tio) != 0) {
+                error = std::strerror(errno);
+                return false;
+            }
+            return true;
+        }
+    }
+    error = "unsupported baud rate (9600, 19200, 38400, 57600, 115200)";
+    return false;
+}
+
+// Reads what arrives within timeout_ms; 0 on timeout, -1 on error
+ssize_t read_wait(int fd, uint8_t *buf, size_t len, unsigned timeout_ms)
+{
+    struct pollfd pfd = {fd, POLLIN, 0};
+    int r = poll(&pfd, 1, (int)timeout_ms);
+
+    if (r <= 0)
+        return r;
+    return read(fd, buf, len);
+}
+
+// Passive capture (ASCII dump, telemetry): everything until the line goes quiet
+bool read_tty(int fd, const InputOptions &opt, std::vector<uint8_t> &data, std::string &error)
+{
+    uint8_t chunk[4096];
+
+    for (;;) {
+        ssize_t n = read_wait(fd, chunk, sizeof chunk, opt.idle_ms);
+        if (n > 0)
+            data.insert(data.end(), chunk, chunk + n);
+        else if (n == 0)
+            return true;
+        else if (errno != EINTR && errno != EAGAIN) {
+            error = std::strerror(errno);
+            return false;
+        }
+    }
+}
+
+// ACK or NAK of one frame: the answer byte, then the frame number
+bool answer(int fd, uint8_t code, uint8_t number, std::string &error)
+{
+    uint8_t out[2] = {code, number};
+
+    if (write(fd, out, sizeof out) != (ssize_t)sizeof out) {
+        error = std::strerror(errno);
+        return false;
+    }
+    return true;
+}
+
+// Live binary download: every download frame is answered once, the raw frames are kept
+// A bad frame gets one NAK; what is left of it (including any 0xA5 inside) is
+// thrown away and nothing is answered until a good frame arrives. If the
+// resend is bad too, the device's DL_ACK_MS timeout sends it again.
+bool pull(int fd, const InputOptions &opt, std::vector<uint8_t> &data, std::string &error)
+{
+    std::vector<uint8_t> in;
+    size_t pos = 0;
+    uint8_t chunk[4096];
+    uint8_t want_no = 0;            // Number of the next new frame (0: the header)
+    bool nak_sent = false;          // Waiting for the resend, bad data gets no answer
+    uint8_t cmd[3] = {'\r', DL_CMD_BINARY, 0};  // CR ends whatever the console holds
+    size_t cmd_len = 2;
+
+    if (opt.pull_host != DL_NO_HOST) {
+        cmd[1] = DL_CMD_SINCE;
+        cmd[2] = (uint8_t)opt.pull_host;
+        cmd_len = 3;
+    }
+    if (write(fd, cmd, cmd_len) != (ssize_t)cmd_len) {
+        error = std::strerror(errno);
+        return false;
+    }
+
+    for (;;) {
+        ssize_t n = read_wait(fd, chunk, sizeof chunk, opt.idle_ms);
+        if (n == 0) {
+            error = data.empty() ? "no answer from the device" : "download stopped (device timed out)";
+            return false;
+        }
+        if (n < 0) {
+            if (errno == EINTR || errno == EAGAIN)
+                continue;
+            error = std::strerror(errno);
+            return false;
+        }
+        in.insert(in.end(), chunk, chunk + n);
+
+        while (pos < in.size()) {
+            if (in[pos] != DL_SOF) {
+                pos++;                  // Console replies, telemetry bytes
+                continue;
+            }
+            if (in.size() - pos < DL_FRAME_OVERHEAD - 1)
+                break;                  // Length byte not here yet
+            size_t want = DL_FRAME_OVERHEAD + in[pos + 3];
+            if (in.size() - pos < want)
+                break;
+
+            const uint8_t *p = in.data() + pos;
+            size_t len = frame_length(p, p + want);
+
+            if (len && p[1] == TM_FRAME_TELEMETRY) {
+                pos += len;             // Not ACKed: the device is not waiting for it
+                continue;
+            }
+            if (!len) {
+                if (nak_sent) {
+                    pos++;              // Rest of a bad frame that was already answered
+                    continue;
+                }
+                // Its number byte may be the broken one, so NAK the frame we are waiting for
+                if (!answer(fd, DL_NAK, want_no, error))
+                    return false;
+                nak_sent = true;
+                tcflush(fd, TCIFLUSH);  // Drop the rest of it, only the resend counts
+                pos = in.size();
+                break;
+            }
+            nak_sent = false;
+            data.insert(data.end(), p, p + len);  // Resends are dropped by decode_binary()
+            pos += len;
+            if (p[2] == want_no)
+                want_no++;              // A new frame, not the copy of one already taken
+            if (!answer(fd, DL_ACK, p[2], error))
+                return false;
+            if (data[data.size() - len + 1] == DL_FRAME_END)
+                return true;
+        }
+        in.erase(in.begin(), in.begin() + pos);
+        pos = 0;
+    }
+}
+
+}  // namespace
+
+bool read_input(const std::string &path, const InputOptions &opt, std::vector<uint8_t> &data,
+                std::string &error)
+{
+    if (path == "-")
+        return read_all(STDIN_FILENO, data, error);
+
+    int fd = open(path.c_str(), O_RDWR | O_NOCTTY);
+    if (fd < 0)
+        fd = open(path.c_str(), O_RDONLY);  // Plain files may be read-only
+    if (fd < 0) {
+        error = path + ": " + std::strerror(errno);
+        return false;
+    }
+
+    bool ok;
+    if (!isatty(fd)) {
+        if (opt.pull_host >= 0) {
+            error = "--pull needs a serial port or pty";
+            ok = false;
+        } else
+            ok = read_all(fd, data, error);
+    } else if (!set_raw(fd, opt.baud, error))
+        ok = false;
+    else if (opt.pull_host >= 0)
+        ok = pull(fd, opt, data, error);
+    else
+        ok = read_tty(fd, opt, data, error);
+    close(fd);
+    return ok;
+}
+
+}  // namespace bb
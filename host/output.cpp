@@ -0,0 +1,193 @@
+/*
+ * File:   output.cpp
+ *
+ * This file (output.cpp) is responsible for:
+ * - Writing a decoded dump as CSV, JSON Lines or the columnar file (bbdecode.h).
+ * - Formatting numbers and times by hand into a large buffer, one fwrite per MB.
+ */
+
+#include "bbdecode.h"
+
+#include <cstring>
+
+namespace bb {
+
+namespace {
+
+class Writer {
+public:
+    explicit Writer(std::FILE *out) : out_(out) { buf_.reserve(kFlush + 256); }
+    ~Writer() { flush(); }
+
+    void str(const char *s) { buf_.append(s); }
+    void chr(char c) { buf_.push_back(c); }
+
+    void num(int64_t v)
+    {
+        char tmp[24];
+        int n = 0;
+        uint64_t u = v < 0 ? 0 - (uint64_t)v : (uint64_t)v;
+
+        do {
+            tmp[n++] = '0' + u % 10;
+            u /= 10;
+        } while (u);
+        if (v < 0)
+            buf_.push_back('-');
+        while (n)
+            buf_.push_back(tmp[--n]);
+    }
+
+    void two(unsigned v)
+    {
+        buf_.push_back('0' + v / 10);
+        buf_.push_back('0' + v % 10);
+    }
+
+    void hms(uint32_t seconds)
+    {
+        two(seconds / 3600);
+        chr(':');
+        two(seconds / 60 % 60);
+        chr(':');
+        two(seconds % 60);
+    }
+
+    // "YYYY-MM-DD" of a Unix time (proleptic Gregorian, UTC)
+    void date(int64_t t)
+    {
+        int64_t z = (t >= 0 ? t : t - 86399) / 86400 + 719468;
+        int64_t era = (z >= 0 ? z : z - 146096) / 146097;
+        unsigned doe = (unsigned)(z - era * 146097);
+        unsigned yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+        unsigned doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+        unsigned mp = (5 * doy + 2) / 153;
+        unsigned d = doy - (153 * mp + 2) / 5 + 1;
+        unsigned m = mp < 10 ? mp + 3 : mp - 9;
+        int64_t y = yoe + era * 400 + (m <= 2);
+
+        num(y);
+        chr('-');
+        two(m);
+        chr('-');
+        two(d);
+    }
+
+    // Day column: the date when the dump has a base date, else the day number
+    void day(int64_t time, bool dated)
+    {
+        if (dated)
+            date(time);
+        else
+            num(time / (int64_t)LOG_SECONDS_PER_DAY);
+    }
+
+    void end_record()
+    {
+        if (buf_.size() >= kFlush)
+            flush();
+    }
+
+    void flush()
+    {
+        if (!buf_.empty())
+            std::fwrite(buf_.data(), 1, buf_.size(), out_);
+        buf_.clear();
+    }
+
+private:
+    static constexpr size_t kFlush = 1 << 20;
+    std::FILE *out_;
+    std::string buf_;
+};
+
+}  // namespace
+
+void write_csv(std::FILE *out, const Dump &dump)
+{
+    Writer w(out);
+    bool has_date = dump.base != 0;
+
+    w.str("seq,day,time,timestamp,event,speed\n");
+    for (const Columns &c : dump.parts) {
+        int64_t midnight = c.midnight;
+        for (size_t i = 0; i < c.size(); i++) {
+            int64_t time = record_time(c, i, midnight);
+            w.num(c.seq[i]);
+            w.chr(',');
+            w.day(time, has_date);
+            w.chr(',');
+            w.hms(c.seconds[i]);
+            w.chr(',');
+            w.num(time);
+            w.chr(',');
+            w.str(event_names[c.event[i]]);
+            w.chr(',');
+            w.num(c.speed[i]);
+            w.chr('\n');
+            w.end_record();
+        }
+    }
+}
+
+void write_jsonl(std::FILE *out, const Dump &dump)
+{
+    Writer w(out);
+    bool has_date = dump.base != 0;
+
+    for (const Columns &c : dump.parts) {
+        int64_t midnight = c.midnight;
+        for (size_t i = 0; i < c.size(); i++) {
+            int64_t time = record_time(c, i, midnight);
+            w.str("{\"seq\":");
+            w.num(c.seq[i]);
+            if (has_date) {
+                w.str(",\"day\":\"");
+                w.date(time);
+                w.str("\"");
+            } else {
+                w.str(",\"day\":");
+                w.day(time, false);
+            }
+            w.str(",\"time\":\"");
+            w.hms(c.seconds[i]);
+            w.str("\",\"timestamp\":");
+            w.num(time);
+            w.str(",\"event\":\"");
+            w.str(event_names[c.event[i]]);
+            w.str("\",\"speed\":");
+            w.num(c.speed[i]);
+            w.str("}\n");
+            w.end_record();
+        }
+    }
+}
+
+// Host is little-endian (x86-64, AArch64), columns are written as they are in memory
+void write_columnar(std::FILE *out, const Dump &dump)
+{
+    uint64_t n = dump.size();
+
+    std::fwrite("BBCOL1\0\0", 1, 8, out);
+    std::fwrite(&n, sizeof n, 1, out);
+    for (const Columns &c : dump.parts)
+        std::fwrite(c.seq.data(), sizeof(uint32_t), c.size(), out);
+    for (const Columns &c : dump.parts)
+        std::fwrite(c.seconds.data(), sizeof(uint32_t), c.size(), out);
+    for (const Columns &c : dump.parts) {
+        int64_t time[4096];         // The time column is built here, a block at a time
+        int64_t midnight = c.midnight;
+        for (size_t i = 0; i < c.size();) {
+            size_t n = 0;
+            for (; n < 4096 && i < c.size(); n++, i++)
+                time[n] = record_time(c, i, midnight);
+            std::fwrite(time, sizeof(int64_t), n, out);
+        }
+    }
+    for (const Columns &c : dump.parts)
+        std::fwrite(c.event.data(), 1, c.size(), out);
+    for (const Columns &c : dump.parts)
+        std::fwrite(c.speed.data(), 1, c.size(), out);
+}
+
+}  // namespace bb
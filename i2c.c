@@ -13,46 +13,160 @@ This file implements I2C communication functions for the PIC16F877A microcontrol
 */
 
 #include "i2c.h"
+#include "i2c_queue.h"
+
+i2c_stats_t i2c_stats[I2C_DEV_COUNT];   // Per-device error counters
+static unsigned char i2c_err;          // Status of the current transaction (sticky)
+
+// Wait while cond holds, at most I2C_TIMEOUT_LOOPS passes
+#define I2C_WAIT(cond) \
+    do { \
+        unsigned short t = I2C_TIMEOUT_LOOPS; \
+        while (cond) \
+        { \
+            if (--t == 0) \
+            { \
+                i2c_err = I2C_ERR_TIMEOUT; \
+                break; \
+            } \
+        } \
+    } while (0)
 
 void init_i2c(void) 
 {
     SSPCON = 0x28;    // Enable I2C in master mode
-    SSPADD = 49;      // Set clock speed (100kHz for 20MHz system clock)
-    SSPSTAT = 0x00;   // Standard speed
+    SSPSTAT = 0x80;   // Standard speed, slew-rate control off
+    SSPADD = I2C_SSPADD(I2C_DS1307_HZ);  // Slowest device until a driver selects its speed
+}
+
+void i2c_set_speed(unsigned char sspadd)
+{
+    while (i2c_queue_busy());  // Never change SCL under a queued transaction
+    I2C_APPLY_SPEED(sspadd);
+}
+
+void i2c_recover(void)
+{
+    SSPEN = 0;        // Hand SCL/SDA back to PORTC
+    RC3 = 0;          // Lines are driven low through TRIS, released high by the pull-ups
+    RC4 = 0;
+    TRISC4 = 1;       // Release SDA
+
+    // Clock out whatever byte a slave is still sending, until it lets go of SDA
+    for (unsigned char n = 0; n < 9 && !RC4; n++)
+    {
+        TRISC3 = 0;   // SCL low
+        __delay_us(5);
+        TRISC3 = 1;   // SCL high
+        __delay_us(5);
+    }
+
+    // STOP condition: SDA rises while SCL is high
+    TRISC3 = 0;
+    __delay_us(5);
+    TRISC4 = 0;
+    __delay_us(5);
+    TRISC3 = 1;
+    __delay_us(5);
+    TRISC4 = 1;
+    __delay_us(5);
+
+    SSPEN = 1;        // MSSP takes the pins again
 }
 
 void i2c_start(void)
 {
+    while (i2c_queue_busy());  // Let queued transactions finish first (bounded by the queue watchdog)
+    i2c_err = I2C_OK; // New transaction
     SEN = 1;          // Initiate Start Condition
-    while (SEN);      // Wait for completion
+    I2C_WAIT(SEN);    // Wait for completion
 }
 
 void i2c_rep_start(void) 
 {
+    if (i2c_err)
+        return;       // Transaction already failed
     RSEN = 1;         // Initiate Repeated Start Condition
-    while (RSEN);     // Wait for completion
+    I2C_WAIT(RSEN);   // Wait for completion
 }
 
-void i2c_stop(void) 
+unsigned char i2c_stop(void) 
 {
-    PEN = 1;          // Initiate Stop Condition
-    while (PEN);      // Wait for completion
+    if (BCLIF)
+    {  // Another master or a glitch pulled SDA while we drove it
+        BCLIF = 0;
+        i2c_err = I2C_ERR_BUS;
+    }
+
+    if (i2c_err < I2C_ERR_TIMEOUT)
+    {
+        PEN = 1;      // Initiate Stop Condition
+        I2C_WAIT(PEN);  // Wait for completion
+    }
+    if (i2c_err >= I2C_ERR_TIMEOUT)
+        i2c_recover(); // Bus or module stuck: free it for the next transaction
+
+    return i2c_err;
+}
+
+unsigned char i2c_status(void)
+{
+    return i2c_err;
 }
 
 void i2c_write(unsigned char data) 
 {
+    if (i2c_err)
+        return;       // Transaction already failed
     SSPBUF = data;    // Load data into buffer
-    while (!SSPIF);   // Wait for transmission to complete
+    I2C_WAIT(!SSPIF); // Wait for transmission to complete
     SSPIF = 0;        // Clear interrupt flag
+    if (!i2c_err && ACKSTAT)
+        i2c_err = I2C_ERR_NACK;  // Device did not acknowledge
 }
 
 unsigned char i2c_read(void) 
 {
+    if (i2c_err)
+        return 0xFF;  // Transaction already failed
     RCEN = 1;         // Enable Receive Mode
-    while (!BF);      // Wait for data reception
+    I2C_WAIT(!BF);    // Wait for data reception
     return SSPBUF;    // Return received data
 }
 
+void i2c_ack(void)
+{
+    if (i2c_err)
+        return;
+    ACKDT = 0;        // ACK: request another byte
+    ACKEN = 1;        // Send acknowledge sequence
+    I2C_WAIT(ACKEN);  // Wait for completion
+}
+
+void i2c_nack(void)
+{
+    if (i2c_err)
+        return;
+    ACKDT = 1;        // NACK: this was the last byte
+    ACKEN = 1;        // Send acknowledge sequence
+    I2C_WAIT(ACKEN);  // Wait for completion
+}
+
+unsigned char i2c_retry(unsigned char dev, unsigned char status, unsigned char *tries)
+{
+    if (status == I2C_OK)
+        return 0;
+    if (status >= I2C_ERR_TIMEOUT)
+        i2c_stats[dev].timeouts++;
+    if ((*tries)++ < I2C_RETRIES)
+    {
+        i2c_stats[dev].retries++;
+        return 1;     // Repeat the whole transaction
+    }
+    i2c_stats[dev].errors++;
+    return 0;         // Give up, caller gets the status
+}
+
 /*
  1 - init_i2c() - Initialize I2C Module
 
@@ -75,6 +189,11 @@ SSPADD = 20,000,000 / 4 x 100000 - 1
  *     = 49;
  SSPSTAT = 0x00; ? Standard I2C speed settings.
 
+? SSPADD is no longer hard-coded: init_i2c() starts at the DS1307 speed
+(I2C_SSPADD(I2C_DS1307_HZ) = 49) with SSPSTAT = 0x80 (SMP = 1, standard mode).
+i2c_set_speed() then switches between 100 kHz and 400 kHz per device; the
+queue (i2c_queue.c) applies the speed stored in each transaction.
+
 ? Example Usage:
 init_i2c();  // Initializes I2C communication
 
@@ -90,6 +209,8 @@ void i2c_start(void)
 
 SEN = 1; ? Initiates the Start Condition (notifies connected I2C devices to prepare for communication).
 while (SEN); ? Waits until the Start Condition is completed.
+while (i2c_queue_busy()); ? Waits first until the interrupt-driven queue (i2c_queue.c) has
+finished its transactions, so a blocking transaction never cuts into a queued one.
 ? Example Usage:
 
 i2c_start();  // Begin I2C communication
@@ -160,5 +281,14 @@ i2c_rep_start()             Sends I2C Repeated Start Condition
 i2c_stop()                  Sends I2C Stop Condition
 i2c_write(data)             Writes data to an I2C device
 i2c_read()                  Reads data from an I2C device
+i2c_ack() / i2c_nack()      Acknowledges a received byte (sequential reads)
+i2c_set_speed(sspadd)       Selects 100 kHz / 400 kHz for the next transaction
+i2c_stop()                  Ends the transaction and returns its status
+i2c_recover()               Frees a stuck bus (9 SCL clocks + STOP)
+i2c_retry(dev, status, &n)  Decides on a retry and counts errors per device
+
+? Timeouts: every wait loop above is bounded by I2C_TIMEOUT_LOOPS through
+I2C_WAIT(), so no I2C call can hang the main loop. A bus transaction takes
+at most (1 + I2C_RETRIES) attempts, each with a bounded number of steps.
 */
 
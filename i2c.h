@@ -11,13 +11,72 @@ This file (i2c.h) is needed to:
 
 #include <xc.h>
 
+#ifndef _XTAL_FREQ
+#define _XTAL_FREQ 20000000  // Define for 20MHz Crystal (same as main.h)
+#endif
+
+// Bus speed: SSPADD = Fosc / (4 * SCL) - 1, rounded so SCL never exceeds the target
+#define I2C_STD_HZ    100000UL
+#define I2C_FAST_HZ   400000UL
+#define I2C_BRG(hz)   ((_XTAL_FREQ + 4 * (hz) - 1) / (4 * (hz)) - 1)
+#define I2C_SSPADD(hz) ((unsigned char)I2C_BRG(hz))
+
+#ifndef I2C_BUS_HZ
+#define I2C_BUS_HZ    I2C_FAST_HZ    // Fastest speed used on the bus
+#endif
+
+// Per-device speed caps
+#define I2C_EEPROM_HZ I2C_BUS_HZ     // 24Cxx: fast mode
+#if I2C_BUS_HZ > I2C_STD_HZ
+#define I2C_DS1307_HZ I2C_STD_HZ     // DS1307: standard mode only
+#else
+#define I2C_DS1307_HZ I2C_BUS_HZ
+#endif
+
+#if I2C_BRG(I2C_DS1307_HZ) > 127 || I2C_BRG(I2C_EEPROM_HZ) < 3
+#error "I2C speed not reachable with this _XTAL_FREQ"
+#endif
+
+/* Load the baud generator; SMP = 1 turns slew-rate control off for standard
+ * mode, SMP = 0 turns it on for fast mode. Only while the bus is idle. */
+#define I2C_APPLY_SPEED(sspadd) \
+    do { SSPADD = (sspadd); SMP = (sspadd) >= I2C_SSPADD(I2C_STD_HZ); } while (0)
+
+// Transaction status (blocking functions)
+#define I2C_OK           0
+#define I2C_ERR_NACK     1   // Device did not acknowledge
+#define I2C_ERR_TIMEOUT  2   // A bus step did not finish, bus recovered
+#define I2C_ERR_BUS      3   // Bus collision, bus recovered
+
+#define I2C_TIMEOUT_LOOPS 1000  // Wait budget per bus step, ~2ms at 20MHz (one 100 kHz byte is 90us)
+#define I2C_RETRIES       2     // Extra attempts after a failed transaction
+
+// Devices with their own error counters
+#define I2C_DEV_EEPROM   0
+#define I2C_DEV_DS1307   1
+#define I2C_DEV_COUNT    2
+
+typedef struct {
+    unsigned short errors;   // Transactions that failed after all retries
+    unsigned short retries;  // Transactions repeated after an error
+    unsigned short timeouts; // Bus steps that timed out (bus recovered)
+} i2c_stats_t;
+
+extern i2c_stats_t i2c_stats[I2C_DEV_COUNT];
+
 // Function Prototypes
 void init_i2c(void);               // Initialize I2C communication
-void i2c_start(void);              // Send I2C Start Condition
+void i2c_set_speed(unsigned char sspadd);  // Select bus speed for the next transaction
+void i2c_start(void);              // Send I2C Start Condition (starts a new transaction status)
 void i2c_rep_start(void);          // Send I2C Repeated Start Condition
-void i2c_stop(void);               // Send I2C Stop Condition
+unsigned char i2c_stop(void);      // Send I2C Stop Condition, returns the transaction status
 void i2c_write(unsigned char data); // Write data to I2C bus
 unsigned char i2c_read(void);      // Read data from I2C bus
+void i2c_ack(void);                // Send ACK (more bytes wanted)
+void i2c_nack(void);               // Send NACK (last byte of a read)
+unsigned char i2c_status(void);    // Status of the current transaction so far
+void i2c_recover(void);            // 9 SCL clocks + STOP to free a stuck bus
+unsigned char i2c_retry(unsigned char dev, unsigned char status, unsigned char *tries);  // 1 = try again
 
 #endif
 
@@ -46,6 +105,8 @@ i2c_rep_start() ? Sends a Repeated Start Condition (used in reading data).
 i2c_stop() ? Sends a Stop Condition (ends communication).
 i2c_write(data) ? Sends a byte of data to an I2C device.
 i2c_read() ? Receives a byte of data from an I2C device.
+i2c_ack() ? Acknowledges a received byte so the slave sends the next one.
+i2c_nack() ? Ends a sequential read after the last byte.
 ? Example Usage:
 
 
@@ -56,8 +117,52 @@ i2c_write(0x55);                 // Write data (0x55)
 i2c_stop();                      // Stop I2C Communication
 ? This writes the value 0x55 to EEPROM address 0x10.
 
+3 - Bus Speed
+
+? I2C_SSPADD(hz) is computed by the compiler from _XTAL_FREQ:
+
+Speed		SSPADD (20MHz)	Actual SCL
+100 kHz		49		100.0 kHz
+400 kHz		12		384.6 kHz
+
+The division rounds up, so the bus never runs faster than the device allows.
+Each driver selects its own cap before a transaction:
+
+i2c_set_speed(I2C_SSPADD(I2C_DS1307_HZ));   // ds1307.c, 100 kHz
+i2c_set_speed(I2C_SSPADD(I2C_EEPROM_HZ));   // ext_eep.c, 400 kHz
+
+4 - Timeouts and Error Handling
+
+? Every wait in i2c.c is bounded by I2C_TIMEOUT_LOOPS. The first failing
+step (timeout or NACK) is latched; the remaining steps of that transaction
+return at once, and i2c_stop() returns the status:
+
+Status			Meaning
+I2C_OK			All bytes acknowledged
+I2C_ERR_NACK		Device did not answer (EEPROM busy, device missing)
+I2C_ERR_TIMEOUT		Module or bus stuck, i2c_recover() was run
+I2C_ERR_BUS		Bus collision (BCLIF), i2c_recover() was run
+
+? i2c_recover() turns the MSSP off, clocks SCL up to 9 times until the slave
+releases SDA, sends a STOP by hand and turns the MSSP back on.
+
+? Drivers repeat a failed transaction with i2c_retry(), which also counts
+errors, retries and timeouts per device in i2c_stats[].
+
+? Example Usage:
+
+unsigned char status, tries = 0;
+do {
+    i2c_start();
+    i2c_write(0xD0);
+    i2c_write(0x00);
+    status = i2c_stop();
+} while (i2c_retry(I2C_DEV_DS1307, status, &tries));
+
 ? Summary of i2c.h
      Section                             Purpose
 Header Guards           ->	  Prevents multiple inclusions of the file
 Function Prototypes     ->    Declares I2C functions for i2c.c
-I2C Operations          ->    Supports Start, Stop, Write, Read*/
\ No newline at end of file
+I2C Operations          ->    Supports Start, Stop, Write, Read
+Bus Speed               ->    SSPADD from _XTAL_FREQ, per-device caps
+Error Handling          ->    Status codes, timeouts, bus recovery, i2c_stats[]*/
\ No newline at end of file
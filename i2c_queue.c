@@ -0,0 +1,259 @@
+/*
+ * File:   i2c_queue.c
+
+ ? Step 38: Setting Up i2c_queue.c (Interrupt-Driven I2C Queue)
+This file (i2c_queue.c) is responsible for:
+? Keeping a small queue of I2C transactions.
+? Running each transaction as a state machine, one step per SSPIF interrupt.
+? Reporting completion through the status field of each transaction.
+ */
+
+#include "i2c_queue.h"
+
+#define I2C_QUEUE_MASK  (I2C_QUEUE_LEN - 1)
+
+// Bus states, each one ends with an SSPIF interrupt
+#define ST_START    0   // START condition sent
+#define ST_WRITE    1   // Address or data byte sent, ACKSTAT valid
+#define ST_RESTART  2   // Repeated START sent
+#define ST_ADDR_R   3   // Read address sent
+#define ST_READ     4   // Byte received
+#define ST_ACK      5   // ACK sent, receive the next byte
+#define ST_LAST     6   // NACK after the last byte sent
+#define ST_STOP     7   // STOP sent
+
+static i2c_txn_t *queue[I2C_QUEUE_LEN];
+static unsigned char q_head;            // Running transaction
+static unsigned char q_tail;            // Next free entry
+static volatile unsigned char q_running;
+static unsigned char q_state;
+static unsigned char q_pos;             // Byte counter within cmd+tx or rx
+static unsigned char q_result;          // I2C_DONE or I2C_NACK
+static volatile unsigned char q_steps;  // Bumped on every SSPIF, read by the watchdog
+static unsigned char q_seen;            // q_steps at the last watchdog tick
+static unsigned char q_stall;           // Watchdog ticks without progress
+static volatile unsigned char q_stalled; // Watchdog fired, i2c_queue_poll() aborts the transaction
+
+static void start_next(void)
+{
+    if (q_head == q_tail)
+    {  // Queue empty: hand the bus back to the blocking functions
+        q_running = 0;
+        SSPIE = 0;
+        return;
+    }
+
+    queue[q_head]->status = I2C_BUSY;
+    q_stall = 0;
+    I2C_APPLY_SPEED(queue[q_head]->sspadd);  // Bus is idle between transactions
+    q_result = I2C_DONE;
+    q_state = ST_START;
+    q_running = 1;
+    SSPIF = 0;
+    SSPIE = 1;
+    SEN = 1;                            // SSPIF when the START is done
+}
+
+static void stop(unsigned char result)
+{
+    q_result = result;
+    PEN = 1;
+    q_state = ST_STOP;
+}
+
+unsigned char i2c_queue_submit(i2c_txn_t *txn)
+{
+    unsigned char next = (q_tail + 1) & I2C_QUEUE_MASK;
+
+    if (next == q_head)
+        return 0;                       // Queue full, try again later
+
+    txn->status = I2C_QUEUED;
+    queue[q_tail] = txn;
+
+    SSPIE = 0;                          // Keep the ISR out while the queue changes
+    q_tail = next;
+    if (!q_running)
+        start_next();
+    else if (!q_stalled)
+        SSPIE = 1;                      // A stalled transaction stays off until it is aborted
+    return 1;
+}
+
+void i2c_queue_poll(void)
+{
+    i2c_txn_t *txn;
+
+    if (!q_stalled)
+        return;
+
+    // Main loop: abort the stalled transaction and free the bus (SSPIE is already off)
+    txn = queue[q_head];
+    i2c_recover();
+    i2c_stats[txn->dev].timeouts++;
+    txn->status = I2C_TIMEOUT;
+    q_head = (q_head + 1) & I2C_QUEUE_MASK;
+    q_stall = 0;                        // Before q_stalled, so the next tick does not fire again
+    q_stalled = 0;
+    start_next();
+}
+
+unsigned char i2c_queue_busy(void)
+{
+    i2c_queue_poll();                   // Every wait on the queue also ends a stall
+    return q_running;
+}
+
+void i2c_queue_isr(void)
+{
+    i2c_txn_t *txn = queue[q_head];
+
+    SSPIF = 0;
+    q_steps++;
+    switch (q_state)
+    {
+        case ST_START:
+            if (txn->cmd_len || txn->tx_len)
+            {
+                SSPBUF = txn->addr;     // Write address
+                q_pos = 0;
+                q_state = ST_WRITE;
+            }
+            else
+            {
+                SSPBUF = txn->addr | 1; // Sequential read from the current address
+                q_state = ST_ADDR_R;
+            }
+            break;
+
+        case ST_WRITE:
+            if (ACKSTAT)
+                stop(I2C_NACK);
+            else if (q_pos < txn->cmd_len)
+                SSPBUF = txn->cmd[q_pos++];
+            else if (q_pos - txn->cmd_len < txn->tx_len)
+                SSPBUF = txn->tx[q_pos++ - txn->cmd_len];
+            else if (txn->rx_len)
+            {
+                RSEN = 1;
+                q_state = ST_RESTART;
+            }
+            else
+                stop(I2C_DONE);
+            break;
+
+        case ST_RESTART:
+            SSPBUF = txn->addr | 1;     // Read address
+            q_state = ST_ADDR_R;
+            break;
+
+        case ST_ADDR_R:
+            if (ACKSTAT)
+            {
+                stop(I2C_NACK);
+                break;
+            }
+            q_pos = 0;
+            RCEN = 1;
+            q_state = ST_READ;
+            break;
+
+        case ST_READ:
+            txn->rx[q_pos++] = SSPBUF;
+            if (q_pos < txn->rx_len)
+            {
+                ACKDT = 0;              // ACK: more bytes wanted
+                q_state = ST_ACK;
+            }
+            else
+            {
+                ACKDT = 1;              // NACK ends the read
+                q_state = ST_LAST;
+            }
+            ACKEN = 1;
+            break;
+
+        case ST_ACK:
+            RCEN = 1;
+            q_state = ST_READ;
+            break;
+
+        case ST_LAST:
+            stop(q_result);
+            break;
+
+        case ST_STOP:
+            txn->status = q_result;
+            q_head = (q_head + 1) & I2C_QUEUE_MASK;
+            start_next();
+            break;
+    }
+}
+
+void i2c_queue_tick(void)
+{
+    if (q_stalled)
+        return;                         // Already flagged, the main loop has not run yet
+    if (!q_running || q_steps != q_seen)
+    {  // Idle or still moving
+        q_seen = q_steps;
+        q_stall = 0;
+        return;
+    }
+    if (++q_stall < I2C_QUEUE_STALL_TICKS)
+        return;
+
+    // No SSPIF for too long: stop the state machine, the main loop does the slow part
+    SSPIE = 0;
+    q_stalled = 1;
+}
+
+/*
+ 1 - i2c_queue_submit() - Queue a Transaction
+
+? Adds the transaction to the queue and, if the bus is idle, sends the
+START condition. It returns at once; the rest runs in the ISR.
+
+2 - i2c_queue_isr() - One Step per Interrupt
+
+? The MSSP sets SSPIF after every START, RESTART, STOP, byte sent, byte
+received and ACK sequence, so each interrupt moves the state machine one
+step:
+
+START -> WRITE (addr, cmd, tx) -> RESTART -> ADDR_R -> READ/ACK ... -> LAST -> STOP
+
+? A NACK on any written byte ends the transaction with I2C_NACK. The EEPROM
+NACKs its address while a write cycle runs, so the caller simply retries.
+
+3 - i2c_queue_tick() - Watchdog
+
+? Called from the Timer1 ISR every 50ms. q_steps counts SSPIF interrupts;
+if it has not moved for I2C_QUEUE_STALL_TICKS ticks while a transaction is
+running, it switches SSPIE off and sets q_stalled. The stall is only known
+from the first tick after it, so one tick is added: the flag is set
+100..150ms after the last SSPIF.
+
+? The abort itself runs in the main loop, in i2c_queue_poll(): the
+transaction ends with I2C_TIMEOUT, i2c_recover() frees the bus and the
+next one starts. i2c_recover() spends about 110us in __delay_us(); in the
+Timer1 ISR that would hold off the 100us LCD tick (Timer2) and the 1ms
+telemetry sample (Timer0), and calling it from both the ISR and the main
+loop would make XC8 duplicate it. i2c_queue_poll() runs from every wait on
+the queue (i2c_queue_busy(), the eep_cache.c write-back) and from
+eep_cache_idle() on each main loop pass.
+
+? A healthy transaction never comes near that: every SSPIF is one byte
+(about 25us at 400kHz), and the EEPROM write cycle (5ms on a 24C512) runs
+after the STOP, where ACK polling sees it as a NACK, not as a stall.
+
+? When the queue is empty SSPIE is cleared, so the blocking functions in
+i2c.c can poll SSPIF again without the ISR taking it.
+
+? Summary of i2c_queue.c
+    Function                     Purpose
+i2c_queue_submit(txn)   Queues a transaction and starts the bus if idle
+i2c_queue_busy()        Reports whether the queue still owns the bus
+i2c_queue_poll()        Aborts a stalled transaction (main loop)
+i2c_queue_isr()         Runs one step of the current transaction (SSPIF)
+i2c_queue_tick()        Flags a stalled transaction (Timer1 watchdog)
+ */
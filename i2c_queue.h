@@ -0,0 +1,88 @@
+/*
+ ? Step 37: Setting Up i2c_queue.h (Interrupt-Driven I2C Queue Header File)
+This file (i2c_queue.h) is needed to:
+? Describe one I2C transaction (write, write-then-read, sequential read).
+? Declare the queue that runs transactions from the MSSP interrupt (SSPIF).
+? Let the main loop keep running while the bus is busy.
+*/
+
+#ifndef I2C_QUEUE_H
+#define I2C_QUEUE_H
+
+#include <xc.h>
+#include "i2c.h"
+#include "timer.h"
+
+#define I2C_QUEUE_LEN  4   // Transactions waiting or running, power of 2
+
+// Transaction status
+#define I2C_IDLE    0   // Never submitted
+#define I2C_DONE    1   // Finished, all bytes acknowledged
+#define I2C_NACK    2   // Finished, device did not acknowledge (EEPROM busy, no device)
+#define I2C_TIMEOUT 3   // Aborted by the watchdog, bus recovered
+#define I2C_QUEUED  4   // Waiting in the queue
+#define I2C_BUSY    5   // On the bus now
+
+#define I2C_QUEUE_STALL_MS     100  // Least time without bus progress before an abort
+#define I2C_QUEUE_STALL_TICKS  (TIMER1_TICKS(I2C_QUEUE_STALL_MS) + 1)  // 3: the first tick comes 0..50ms after the stall
+
+#define I2C_PENDING(txn)  ((txn)->status >= I2C_QUEUED)  // Still queued or running
+
+// One transaction: START, addr, cmd[], tx[], (RESTART, addr|1, rx[]), STOP
+typedef struct {
+    unsigned char addr;                 // Device address, write form (e.g. 0xA0)
+    unsigned char sspadd;               // Bus speed, I2C_SSPADD(device cap)
+    unsigned char dev;                  // I2C_DEV_* for the error counters
+    unsigned char cmd[2];               // Register / word address bytes
+    unsigned char cmd_len;              // 0..2
+    const unsigned char *tx;            // Data written after cmd[]
+    unsigned char tx_len;
+    unsigned char *rx;                  // Data read after a restart (rx_len = 0: no read)
+    unsigned char rx_len;
+    volatile unsigned char status;      // I2C_* status, set by the ISR
+} i2c_txn_t;
+
+// Function Prototypes
+unsigned char i2c_queue_submit(i2c_txn_t *txn);  // Queue a transaction, 0 if the queue is full
+unsigned char i2c_queue_busy(void);               // 1 while any transaction is queued or running
+void i2c_queue_poll(void);                        // Main loop: aborts a transaction the watchdog flagged
+void i2c_queue_isr(void);                         // Called from isr() on SSPIF
+void i2c_queue_tick(void);                        // Called from isr() every 50ms (watchdog, flags only)
+
+#endif
+
+/*
+ 1 - Transaction Types
+
+Type			cmd_len	tx_len	rx_len	Bus sequence
+Write			1..2	n	0	S addr cmd tx P
+Write-then-read		1..2	0	n	S addr cmd Sr addr|1 rx P
+Sequential read		0	0	n	S addr|1 rx P
+
+? The transaction struct must stay valid (static) until status is no longer
+pending. tx and rx buffers must not be touched while the transaction runs.
+
+? Example: read DS1307 registers 0..2 in the background
+
+static i2c_txn_t txn;
+txn.addr = 0xD0; txn.sspadd = I2C_SSPADD(I2C_DS1307_HZ); txn.dev = I2C_DEV_DS1307;
+txn.cmd[0] = 0x00; txn.cmd_len = 1;
+txn.tx_len = 0; txn.rx = buf; txn.rx_len = 3;
+i2c_queue_submit(&txn);
+...
+if (txn.status == I2C_DONE) ... buf[] holds seconds, minutes, hours
+
+2 - Blocking Functions
+
+? i2c_start() waits for the queue to drain before it takes the bus, so the
+blocking drivers (ext_eep.c, ds1307.c) and the queue never overlap.
+
+3 - Watchdog
+
+? i2c_queue_tick() runs from the Timer1 ISR. If a transaction makes no
+progress for I2C_QUEUE_STALL_TICKS ticks (a stuck bus never raises SSPIF),
+it flags it. i2c_queue_poll(), from the main loop or any wait on the queue,
+then ends it with I2C_TIMEOUT, recovers the bus and starts the next
+transaction. So the queue, and every wait on it, is bounded as well, and
+no bus recovery delay ever runs inside an interrupt.
+*/
@@ -16,16 +16,44 @@ This file handles Timer1 interrupts, which are used for:
 #include "main.h"
 
 void __interrupt() isr(void) {
+    if (T0IF && T0IE) {     // Telemetry sample clock, first for the lowest jitter
+        T0IF = 0;
+        telemetry_tick();
+    }
+
     if (TMR1IF) {   // Check if Timer1 Interrupt Flag is set
-        TMR1 = TMR1 + 3038;  // Reload Timer1 for next interrupt
+        TMR1 = TMR1 + TIMER1_PRELOAD;  // Reload Timer1 for next interrupt (50ms, timer.h)
+
+        snapshot_tick();  // 10 Hz speed/gear samples for the pre-trigger ring
+        i2c_queue_tick(); // Flag a stalled background I2C transaction (aborted in the main loop)
+        rtc_tick();       // Advance the software clock
+        download_tick();  // ACK timeout of a binary download
 
-        if (++count == 80) {  // 80 overflows = 4 seconds
+        if (++count >= TIMER1_TICKS_PER_SEC) {  // 20 overflows = 1 second
             count = 0;
             tm--;   // Decrease timeout counter
         }
         
         TMR1IF = 0;  // Clear the Timer1 Interrupt Flag
     }
+
+    if (SSPIF && SSPIE) {   // I2C queue: START/STOP/byte done
+        i2c_queue_isr();
+    }
+
+    if ((RCIF && RCIE) || (TXIF && TXIE)) {  // UART: byte received / TXREG free
+        uart_isr();
+    }
+
+    if (TMR2IF && TMR2IE) { // LCD writer: one nibble every CLCD_TICK_US
+        TMR2IF = 0;
+        clcd_tick();
+    }
+
+    if (INTF && INTE) {     // DS1307 SQW/OUT 1 Hz edge (RTC_USE_SQW)
+        INTF = 0;
+        rtc_sqw();
+    }
 }
 /*void __interrupt() isr(void) 
 {
@@ -44,7 +72,7 @@ This ensures periodic interrupts for countdown operations
  ? This keeps track of time in seconds.
 
 Every time Timer1 overflows (every 50ms), count increases.
-After 80 overflows (50ms * 80 = 4 seconds), tm-- decreases.
+After TIMER1_TICKS_PER_SEC overflows (50ms * 20 = 1 second), tm-- decreases.
 tm is used for password timeout and lockout countdown.
 
         if (++count == 80) 
@@ -81,10 +109,18 @@ It is executed whenever Timer1 overflows.
  ? Summary of isr.c
         Function                                  Purpose
 void __interrupt() isr(void)    	Executes on Timer1 interrupt
+if (T0IF && T0IE)                   Takes the next telemetry sample (telemetry_tick(), 1 ms)
 if (TMR1IF)                         Checks if Timer1 overflowed
-TMR1 = TMR1 + 3038                  Reloads Timer1 for the next cycle
-if (++count == 80) { tm--; }        Counts 4-second intervals
+TMR1 = TMR1 + TIMER1_PRELOAD        Reloads Timer1 for the next cycle
+snapshot_tick()                     Samples speed/gear into the pre-trigger ring
+i2c_queue_tick()                    Watchdog for the background I2C queue
+rtc_tick() / rtc_sqw()              Advance the software clock (Timer1 or SQW/OUT)
+download_tick()                     Counts down the binary download ACK timeout
+if (++count >= 20) { tm--; }        Counts 1-second intervals (password timeout, lockout)
 TMR1IF = 0;                         Clears interrupt flag
+if (SSPIF && SSPIE)                 Runs the next step of a queued I2C transaction
+RCIF / TXIF                         Moves one UART byte to/from the rings (uart_isr())
+if (TMR2IF && TMR2IE)               Sends the next queued LCD nibble (clcd_tick())
  
  */
 
@@ -0,0 +1,93 @@
+/*
+ * File:   log_record.c
+
+ ? Step 30: Setting Up log_record.c (Packed Log Record Encode/Decode)
+This file (log_record.c) is responsible for:
+? Packing time, event and speed into one 4-byte record.
+? Unpacking and validating records read back from EEPROM.
+? Converting DS1307 BCD time into seconds since midnight.
+
+Plain C only, so the same file builds for the PIC and for host tools.
+ */
+
+#include "log_record.h"
+
+void log_record_pack(const log_entry_t *entry, unsigned char lap, unsigned char *rec)
+{
+    unsigned long word;
+
+    word = (entry->seconds << 15)
+         | ((unsigned long)(entry->event & 0x0F) << 11)
+         | ((unsigned long)entry->speed << 3)
+         | ((unsigned long)(lap & 1) << 2)
+         | 0x03;                            // Reserved bits
+
+    rec[0] = word >> 24;
+    rec[1] = word >> 16;
+    rec[2] = word >> 8;
+    rec[3] = word;
+}
+
+unsigned char log_record_unpack(const unsigned char *rec, log_entry_t *entry)
+{
+    unsigned long word = ((unsigned long)rec[0] << 24)
+                       | ((unsigned long)rec[1] << 16)
+                       | ((unsigned short)rec[2] << 8)
+                       | rec[3];
+
+    entry->seconds = word >> 15;
+    entry->event = (word >> 11) & 0x0F;
+    entry->speed = (word >> 3) & 0xFF;
+
+    // Erased or garbage records are out of range
+    return entry->seconds < LOG_SECONDS_PER_DAY && entry->event < LOG_EVENT_COUNT;
+}
+
+unsigned char log_record_lap(const unsigned char *rec)
+{
+    return (rec[3] >> 2) & 1;
+}
+
+static unsigned char bcd_to_bin(unsigned char bcd)
+{
+    return (bcd >> 4) * 10 + (bcd & 0x0F);
+}
+
+unsigned long log_bcd_to_seconds(unsigned char hours, unsigned char minutes, unsigned char seconds)
+{
+    return bcd_to_bin(hours & 0x3F) * 3600UL    // Mask the 12/24 hour mode bit
+         + bcd_to_bin(minutes & 0x7F) * 60U
+         + bcd_to_bin(seconds & 0x7F);           // Mask the clock halt (CH) bit
+}
+
+void log_seconds_to_hms(unsigned long seconds, unsigned char *hms)
+{
+    unsigned short minutes = seconds / 60;
+
+    hms[0] = minutes / 60;            // Hours
+    hms[1] = minutes % 60;            // Minutes
+    hms[2] = seconds - minutes * 60UL; // Seconds
+}
+
+/*
+ 1 - log_record_pack() - Encode One Record
+
+? Example:
+
+12:30:45, event 4 (G2), speed 40, lap 0
+seconds = 12*3600 + 30*60 + 45 = 45045
+word    = 45045 << 15 | 4 << 11 | 40 << 3 | 0 << 2 | 3 = 0x57FAA143
+rec     = 57 FA A1 43
+
+2 - log_record_unpack() - Decode One Record
+
+? Returns 1 for a valid record and 0 for an erased or corrupt one.
+
+? Summary of log_record.c
+    Function                          Purpose
+log_record_pack()         Packs time, event, speed and lap bit into 4 bytes
+log_record_unpack()       Unpacks and validates a 4-byte record
+log_record_lap()          Returns the lap bit of a packed record
+log_bcd_to_seconds()      Converts DS1307 BCD time to seconds since midnight
+log_seconds_to_hms()      Splits seconds since midnight into hours, minutes, seconds
+ */
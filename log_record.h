@@ -0,0 +1,60 @@
+/*
+ ? Step 29: Setting Up log_record.h (Packed Log Record Format)
+This file (log_record.h) is needed to:
+? Define the packed 4-byte format of one event record in EEPROM.
+? Declare the encode/decode routines shared by the firmware and the host decoder.
+? Keep the record format in one place so both sides always agree.
+
+This header does not include <xc.h> so it can also be used by host tools.
+*/
+
+#ifndef LOG_RECORD_H
+#define LOG_RECORD_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define LOG_RECORD_SIZE      4          // Bytes in one packed record
+#define LOG_SECONDS_PER_DAY  86400UL    // Valid seconds-of-day are 0..86399
+#define LOG_EVENT_MAX        15         // 4-bit event code
+#define LOG_EVENT_COUNT      10         // Codes in use: 8 gears/collision, download (8), clear (9)
+
+// Decoded form of one record
+typedef struct {
+    unsigned long seconds;  // Seconds since midnight (17 bits)
+    unsigned char event;    // Index into event[] (4 bits)
+    unsigned char speed;    // Speed (8 bits)
+} log_entry_t;
+
+// Function Prototypes
+void log_record_pack(const log_entry_t *entry, unsigned char lap, unsigned char *rec);  // Entry -> 4 bytes
+unsigned char log_record_unpack(const unsigned char *rec, log_entry_t *entry);          // 4 bytes -> entry, 0 if invalid
+unsigned char log_record_lap(const unsigned char *rec);                                 // Lap bit of a packed record
+unsigned long log_bcd_to_seconds(unsigned char hours, unsigned char minutes, unsigned char seconds);  // DS1307 BCD -> seconds
+void log_seconds_to_hms(unsigned long seconds, unsigned char *hms);                    // seconds -> {HH, MM, SS} (binary)
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
+
+/*
+ 1 - Packed Record Layout (32 bits, most significant byte first)
+
+Bits	Field
+31..15	Seconds since midnight (0..86399)
+14..11	Event code (index into event[])
+10..3	Speed (0..255)
+2	Lap bit (used by event_log.c to find the newest record)
+1..0	Reserved (written as 1)
+
+? An erased record (FF FF FF FF) decodes to 131071 seconds, which is out of
+range, so log_record_unpack() reports it as invalid. Event codes at or above
+LOG_EVENT_COUNT are rejected as well, so a corrupt record can never index
+past the end of event[].
+
+? Compared with the old 5-byte BCD record (HH MM SS EVENT SPEED) one record
+now takes 4 bytes and needs no separate sequence number.
+*/
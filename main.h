@@ -8,7 +8,15 @@
 #include "ds1307.h"
 #include "ext_eep.h"
 #include "i2c.h"
+#include "i2c_queue.h"
 #include "uart.h"
+#include "event_log.h"
+#include "eep_cache.h"
+#include "snapshot.h"
+#include "download_log.h"
+#include "console.h"
+#include "telemetry.h"
+#include "timer.h"
 
  //2. Diffrant maccross
 #define _XTAL_FREQ 20000000  // Define for 20MHz Crystal
@@ -29,12 +37,12 @@ Current system state (main_f) ? Determines whether the system is in Dashboard, P
 User Input (key, p_key) ? Stores the last pressed key.
 RTC Time (time[], clock_reg[]) ? Stores current time and RTC registers.
 Speed (speed, speeds[]) ? Stores car speed read from ADC.
-EEPROM Logging (index, val, over_flow) ? Tracks stored logs and overflow conditions.
+Event (index) ? Current event/gear, stored with each log record (log position lives in event_log.c).
 Security (pass, tm) ? Stores entered password and block time countdown.*/
 
 unsigned char main_f = 0;  // Stores the current system state (Dashboard, Password, Menu)
 unsigned char menu_f;       // Stores the selected menu option
-char *event[] = {"ON", "GN", "GR", "G1", "G2", "G3", "G4", "C "};  // Event names
+char *event[LOG_EVENT_COUNT] = {"ON", "GN", "GR", "G1", "G2", "G3", "G4", "C ", "DL", "CL"};  // Event names (DL/CL mark download/clear)
 //char time[9] = "12:00:00";  // Stores the current time in HH:MM:SS format
 unsigned char clock_reg[3]; // Stores RTC register values
 char index;                 // Used for EEPROM log storage
@@ -45,8 +53,6 @@ unsigned char speed;        // Stores the current speed
 unsigned char pass;         // Stores the entered password
 unsigned char tm;           // Countdown timer variable
 unsigned short count;       // Timer counter for ISR
-unsigned char val;          // Stores log count
-unsigned char over_flow;    // Used to track EEPROM overflow
 extern unsigned short wait1;  // Declare wait1 globally
 extern unsigned char i;      // Loop counter
 extern unsigned char o;      // Flag for tracking download start
@@ -68,11 +74,11 @@ void display_dashboard(void);   // Show dashboard on LCD
 void gear_change(unsigned char key); // Change gear when keypad key is pressed
 void save_log(void);            // Save event logs to EEPROM
 void password(void);            // Handle password entry
-void init_timer1(void);         // Initialize Timer1 for countdowns
 void menu(char key);            // Handle menu navigation
 void view_log(char key);        // View logs stored in EEPROM
 void download_log();            // Send logs via UART to PC
 void clear_log(char key);       // Clear stored logs
+void clear_log_records(void);   // Clear stored logs now (no LCD)
 void settime(char key);         // Set RTC time
 void change_pass(char key);     // Change system password
 void get_time(void);            // Read current time from RTC
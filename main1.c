@@ -24,9 +24,11 @@ void init_config(void)
     init_matrix_keypad(); //Initialized 4x4 Keypad
     init_adc();            // Initialize ADC for speed sensor
     init_timer1();         // Initialize Timer1 for countdown
+    init_uart();           // Initialize UART (interrupt-driven TX/RX rings)
     init_i2c();            // Initialize I2C for EEPROM & RTC
     init_ds1307();         // Initialize Real-Time Clock (RTC)
-    write_ext_eep(200, 10); // Store default password (10) in EEPROM
+    log_init();            // Recover log position from EEPROM (tried again by log_append() after a bus error)
+    eep_cache_write(EEP_PASSWORD_ADDR, 10); // Store default password (10), written back only if it changed
 }
 
 void main(void) 
@@ -35,7 +37,16 @@ void main(void)
     
     while(1) //Infinite loop (Runs forever)
     {
-        get_time(); //Fetch the current time from RTC
+        eep_cache_idle(); //Write back cached EEPROM bytes when the EEPROM is free
+        snapshot_task(); //Flush a frozen crash window to EEPROM
+        console_task(); //Run a command line received over the UART
+        download_task(); //Stream the next log line if the UART has room
+        telemetry_task(); //Send sampled telemetry frames if the UART has room
+        get_time(); //Current time from the software clock (RAM, re-synced from the RTC once a minute)
+        /* ADFM = 0 (ADCON1 = 0x0E): the 10-bit result is left-justified, read_adc()
+           returns 0x0000..0xFFC0. >> 8 keeps ADRESH, 0..255; 255 * 100 = 25500 fits
+           a 16-bit int, and 25500 / 256 = 99. */
+        speed = (read_adc(0) >> 8) * 100 / 256; //Speed 0..99 from the AN0 sensor, sampled by snapshot_tick()
         key = read_switches(STATE_CHANGE);
         if (main_f == DASHBOARD)
         {
@@ -49,5 +60,6 @@ void main(void)
         {
             menu(key);
         }
+        clcd_flush(); //Send only the LCD cells that changed this pass
     }
 }
@@ -44,6 +44,8 @@ Columns (RB1, RB2, RB3) ? Used as outputs (to activate keypad rows).
 #define COL2    PORTBbits.RB2
 #define COL3    PORTBbits.RB3
 
+#define MATRIX_KEYPAD_COL_MASK  0x07  // PORTB bits scan_key() reads as columns (RB0..RB2)
+
 /*
  4 Define Keypad Columns (Outputs)
  ? Defines two detection modes for read_switches() function:
@@ -37,7 +37,7 @@ static int keycount = 0;
 pass = 0  ? Clears any previously entered password.
 tm = 5    ? Sets a 5-second timeout to enter the password.
 attempt = 50 ? User has 50 chances to enter the correct password.
-Clears the LCD screen using CLEAR_DISP_SCREEN.
+Clears the LCD screen using clcd_clear().
 */
 void password(void) 
 {
@@ -46,7 +46,7 @@ void password(void)
     tm = 5;
     char i = 0;
     unsigned char attempt = 50;
-    CLEAR_DISP_SCREEN;
+    clcd_clear();
     unsigned char wait = 0;
 
     
@@ -89,6 +89,8 @@ Prints * (hidden character) on LCD for each digit entered.
  ? Password Validation
 ? Checks the entered password against stored EEPROM data:
 
+The stored password is read through eep_cache_read(), so only the first
+attempt after boot touches the I2C bus.
 If correct (pass == o_pass) ? Enter the Menu System.
 If incorrect ?
 Displays "Wrong Password".
@@ -97,10 +99,14 @@ Resets the password entry after 200 loops.
  */   
         if (i == 4) 
         {
-            if (pass == (o_pass = read_ext_eep(200))) 
+            unsigned char stored;
+
+            // An unreadable EEPROM never matches, it only costs an attempt
+            if (eep_cache_read(EEP_PASSWORD_ADDR, &stored) == I2C_OK &&
+                pass == (o_pass = stored)) 
             {
                 main_f = MENU; // Correct password ? Enter Menu
-                CLEAR_DISP_SCREEN;
+                clcd_clear();
                 return;
             } 
             else 
@@ -115,7 +121,7 @@ Resets the password entry after 200 loops.
                     pass = 0;  // Reset password
                     i = 0;     // Reset input index
                     wait = 0;
-                    CLEAR_DISP_SCREEN;
+                    clcd_clear();
                 }
             }
              
@@ -153,7 +159,7 @@ Resets login after timeout expires.
 1) count = 0 ? Resets the countdown timer.
 2) tm = 5 ? Allows 5 seconds for password entry again.
 3) attempt = '2' ? Resets the attempt counter to '2' (ASCII value for 2).
-4) CLEAR_DISP_SCREEN ? Clears the LCD screen before returning to the dashboard.
+4) clcd_clear() ? Clears the LCD screen before returning to the dashboard.
 
  */
             
@@ -162,9 +168,10 @@ Resets login after timeout expires.
                 count = 0;
                 tm = 5;
                 attempt = '2';
-                CLEAR_DISP_SCREEN;
+                clcd_clear();
             }
         }
+        clcd_flush();  // This loop does not return to main(), update the LCD here
     }
     
 /*
@@ -174,7 +181,7 @@ Resets login after timeout expires.
 Clears the LCD screen to remove any old messages.
 Sets main_f = DASHBOARD ? The system returns to the Dashboard after unlocking.
 */
-    CLEAR_DISP_SCREEN;
+    clcd_clear();
     main_f = DASHBOARD;
 }
 
@@ -199,7 +206,7 @@ void menu(char key)
             keycount = 0;
             if (key == MK_SW11) 
             {
-                CLEAR_DISP_SCREEN;
+                clcd_clear();
                 main_f = MENU_ENTER;
                 menu_f = sf ? i + 1 : i;
                 i = 0;
@@ -210,7 +217,7 @@ void menu(char key)
                 main_f = DASHBOARD;
                 i = 0;
                 sf = 0;
-                CLEAR_DISP_SCREEN;
+                clcd_clear();
                 return;
             }
         }
@@ -238,8 +245,10 @@ void menu(char key)
 
 Shows menu items on LCD (VIEW LOG, SET TIME, etc.).
 Moves cursor (->) to the selected item.
+The frame is redrawn every pass; clcd_flush() only sends what changed.
      */
 
+    clcd_clear();  // Redraw from a blank frame, only changed cells reach the LCD
     if (!sf)
         clcd_print("->", LINE1(0));
     else
@@ -0,0 +1,45 @@
+/*
+ * File:   save_log.c
+
+ ? Step 25: Setting Up save_log.c (Save Event Log to EEPROM)
+This file (save_log.c) is responsible for:
+? Building one log record (Time, Event, Speed) for the current event.
+? Handing the record to the circular log engine (event_log.c).
+ */
+
+#include <xc.h>
+#include "main.h"
+#include "event_log.h"
+
+void save_log(void)
+{
+    log_entry_t entry;
+
+    // clock_reg[] is refreshed by get_time() in the main loop
+    entry.seconds = log_bcd_to_seconds(clock_reg[2], clock_reg[1], clock_reg[0]);
+    entry.event = index;       // Event index into event[]
+    entry.speed = speed;
+
+    // Packed record in one I2C transaction and one EEPROM write cycle
+    log_append(&entry);
+}
+
+/*
+ 1 - save_log() - Save One Event Record
+
+? Fields of one record (packed into LOG_RECORD_SIZE = 4 bytes, see log_record.h):
+
+Field	Data
+seconds	Time of the event as seconds since midnight
+event	Event index (event[])
+speed	Speed
+
+? log_append() packs the record into one 8-byte slot that never straddles
+an EEPROM page: record and CRC in one write cycle, then the commit marker
+in a second one, so a power loss can never leave a half-written record
+that reads back as valid.
+
+? Summary of save_log.c
+    Function                         Purpose
+save_log()              Stores the current event in the circular EEPROM log
+ */
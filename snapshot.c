@@ -0,0 +1,149 @@
+/*
+ * File:   snapshot.c
+
+ ? Step 36: Setting Up snapshot.c (Pre-Trigger Snapshot)
+This file (snapshot.c) is responsible for:
+? Sampling speed and gear at 10 Hz into a RAM ring from the Timer1 ISR.
+? Freezing the window when hard braking or a collision is detected.
+? Writing the frozen window to the reserved EEPROM region in one burst.
+ */
+
+#include <xc.h>
+#include "main.h"
+#include "snapshot.h"
+#include "log_record.h"
+#include "crc8.h"
+
+#define SNAP_MASK    (SNAP_SAMPLES - 1)
+
+// Ring states
+#define SNAP_ARMED   0   // Sampling, waiting for a trigger
+#define SNAP_POST    1   // Triggered, taking the post-trigger samples
+#define SNAP_FROZEN  2   // Window complete, waiting for snapshot_task()
+#define SNAP_REFILL  3   // Flushed, refilling the ring before re-arming
+
+static unsigned char snap_speed[SNAP_SAMPLES];  // Speed samples
+static unsigned char snap_event[SNAP_SAMPLES];  // Event (gear) samples
+static unsigned char snap_head;                 // Next sample goes here (= oldest sample)
+static unsigned char snap_tick;                 // Timer1 ticks since the last sample
+static unsigned char snap_left;                 // Samples left in SNAP_POST / SNAP_REFILL
+static volatile unsigned char snap_state;
+static unsigned char snap_reason;               // SNAP_REASON_*
+static unsigned char snap_clock[3];             // clock_reg[] at the trigger
+
+static void trigger(unsigned char reason)
+{
+    snap_reason = reason;
+    snap_clock[0] = clock_reg[0];
+    snap_clock[1] = clock_reg[1];
+    snap_clock[2] = clock_reg[2];
+    snap_left = SNAP_POST_SAMPLES;
+    snap_state = SNAP_POST;
+}
+
+void snapshot_tick(void)
+{
+    unsigned char now, before, last_event;
+
+    if (snap_state == SNAP_FROZEN || ++snap_tick < SNAP_TICKS)
+        return;
+    snap_tick = 0;
+
+    now = speed;
+    before = snap_speed[(snap_head - SNAP_BRAKE_SAMPLES) & SNAP_MASK];
+    last_event = snap_event[(snap_head - 1) & SNAP_MASK];
+
+    snap_speed[snap_head] = now;
+    snap_event[snap_head] = index;
+    snap_head = (snap_head + 1) & SNAP_MASK;
+
+    if (snap_state == SNAP_ARMED)
+    {
+        if (index == SNAP_COLLISION_EVENT && last_event != SNAP_COLLISION_EVENT)
+            trigger(SNAP_REASON_COLLISION);
+        else if (before > now && before - now >= SNAP_BRAKE_DROP)
+            trigger(SNAP_REASON_BRAKE);
+    }
+    else if (--snap_left == 0)
+    {
+        // Post-trigger window complete, or ring refilled after a flush
+        snap_state = (snap_state == SNAP_POST) ? SNAP_FROZEN : SNAP_ARMED;
+    }
+}
+
+// Writes one ring buffer oldest first, in at most two block writes
+static unsigned char write_ring(unsigned short address, const unsigned char *ring, unsigned char crc)
+{
+    unsigned char first = SNAP_SAMPLES - snap_head;   // snap_head .. end of ring
+
+    write_ext_eep_block(address, ring + snap_head, first);
+    crc = crc8(crc, ring + snap_head, first);
+    if (snap_head != 0)
+    {
+        write_ext_eep_block(address + first, ring, snap_head);
+        crc = crc8(crc, ring, snap_head);
+    }
+    return crc;
+}
+
+void snapshot_task(void)
+{
+    unsigned char header[SNAP_CRC_OFFSET + 1];
+    unsigned long seconds;
+    unsigned char crc;
+
+    if (snap_state != SNAP_FROZEN)
+        return;
+
+    // Invalidate the old snapshot first, so a torn burst is never read as valid
+    write_ext_eep(SNAP_AREA_START + SNAP_COMMIT_OFFSET, 0xFF);
+
+    seconds = log_bcd_to_seconds(snap_clock[2], snap_clock[1], snap_clock[0]);
+    header[0] = seconds >> 16;
+    header[1] = seconds >> 8;
+    header[2] = seconds;
+    header[3] = snap_reason;
+    header[4] = SNAP_RATE_HZ;
+    header[5] = SNAP_SAMPLES - SNAP_POST_SAMPLES;
+
+    crc = crc8(CRC8_INIT, header, SNAP_CRC_OFFSET);
+    crc = write_ring(SNAP_AREA_START + SNAP_HEADER_SIZE, snap_speed, crc);
+    crc = write_ring(SNAP_AREA_START + SNAP_HEADER_SIZE + SNAP_SAMPLES, snap_event, crc);
+    header[SNAP_CRC_OFFSET] = crc;
+
+    write_ext_eep_block(SNAP_AREA_START, header, sizeof header);
+    write_ext_eep(SNAP_AREA_START + SNAP_COMMIT_OFFSET, SNAP_COMMIT_MARK);
+
+    // Re-arm only after a whole new window, so one incident gives one snapshot
+    snap_left = SNAP_SAMPLES;
+    snap_state = SNAP_REFILL;
+}
+
+/*
+ 1 - snapshot_tick() - Sample from the ISR
+
+? Runs inside isr() every 50ms (TIMER1_TICK_MS) and takes a sample every
+SNAP_TICKS ticks, SNAP_RATE_HZ = 10 samples per second.
+It only copies two bytes (speed, index) into the ring, so the ISR stays short.
+speed is refreshed from the ADC by the main loop.
+
+? Triggers (checked only while armed):
+Collision	index changes to SNAP_COLLISION_EVENT ("C ")
+Hard braking	speed dropped by SNAP_BRAKE_DROP or more within SNAP_BRAKE_MS (5 samples)
+
+? After a trigger SNAP_POST_SAMPLES more samples are taken, then the ring is
+frozen: it holds 24 samples before and 8 samples after the trigger.
+
+2 - snapshot_task() - Flush to EEPROM
+
+? Called once per main loop pass, does nothing unless a window is frozen.
+The ring is unrolled oldest first, so the EEPROM copy needs no head pointer.
+Order of writes: commit marker erased, samples, header with CRC, commit marker.
+
+? Example (24C02, 8-byte pages): 72 bytes = 9 page writes, about 45ms.
+
+? Summary of snapshot.c
+    Function                     Purpose
+snapshot_tick()         Samples speed/gear at 10 Hz and detects triggers (ISR)
+snapshot_task()         Writes a frozen window to the reserved EEPROM region
+ */
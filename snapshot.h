@@ -0,0 +1,74 @@
+/*
+ ? Step 35: Setting Up snapshot.h (Pre-Trigger Snapshot Header File)
+This file (snapshot.h) is needed to:
+? Define the RAM ring that keeps the last few seconds of speed and gear samples.
+? Define the reserved EEPROM region a frozen window is flushed to.
+? Declare the functions called from the timer ISR and from the main loop.
+*/
+
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include "ext_eep.h"
+#include "timer.h"
+
+// Sampling (Timer1 interrupts every TIMER1_TICK_MS = 50ms)
+#define SNAP_RATE_HZ        10   // Samples per second
+#define SNAP_TICKS          (TIMER1_TICKS_PER_SEC / SNAP_RATE_HZ)  // Timer1 ticks per sample (2)
+#define SNAP_SAMPLES        32   // Samples in the window, power of 2 (3.2 s at 10 Hz)
+#define SNAP_POST_SAMPLES   8    // Samples kept after the trigger (0.8 s)
+
+// Triggers
+#define SNAP_COLLISION_EVENT 7   // event[7] = "C "
+#define SNAP_BRAKE_MS       500  // Hard braking: speed drop measured over 0.5 s ...
+#define SNAP_BRAKE_SAMPLES  (SNAP_BRAKE_MS * SNAP_RATE_HZ / 1000)      // 5 samples
+#define SNAP_BRAKE_DROP     15   // ... of at least this much
+#define SNAP_REASON_BRAKE     1
+#define SNAP_REASON_COLLISION 2
+
+// Reserved EEPROM region, just below the config area
+#define SNAP_HEADER_SIZE    8
+#define SNAP_AREA_SIZE      (SNAP_HEADER_SIZE + 2 * SNAP_SAMPLES)
+#define SNAP_AREA_START     (EEP_CONFIG_START - SNAP_AREA_SIZE)
+#define SNAP_CRC_OFFSET     6
+#define SNAP_COMMIT_OFFSET  7
+#define SNAP_COMMIT_MARK    0xA5
+
+#if (SNAP_SAMPLES & (SNAP_SAMPLES - 1)) != 0
+#error "SNAP_SAMPLES must be a power of 2"
+#endif
+#if SNAP_TICKS * SNAP_RATE_HZ != TIMER1_TICKS_PER_SEC
+#error "SNAP_RATE_HZ must divide TIMER1_TICKS_PER_SEC"
+#endif
+#if SNAP_BRAKE_SAMPLES < 1 || SNAP_BRAKE_SAMPLES >= SNAP_SAMPLES
+#error "SNAP_BRAKE_MS does not fit the ring"
+#endif
+
+// Function Prototypes
+void snapshot_tick(void);   // Timer1 ISR: take a sample, check triggers
+void snapshot_task(void);   // Main loop: flush a frozen window to EEPROM
+
+#endif
+
+/*
+ 1 - EEPROM Region (SNAP_AREA_SIZE = 72 bytes)
+
+Offset	Content
+0..2	Time of the trigger, seconds since midnight (most significant byte first)
+3	Trigger reason (SNAP_REASON_BRAKE / SNAP_REASON_COLLISION)
+4	Sample rate in Hz (SNAP_RATE_HZ, 10: samples are 100ms apart)
+5	Number of samples taken before the trigger
+6	CRC-8 of bytes 0..5 and all samples
+7	Commit marker (SNAP_COMMIT_MARK), written last
+8..39	Speed samples, oldest first
+40..71	Event (gear) samples, oldest first
+
+? Only the newest snapshot is kept. The region is written once per trigger,
+so it wears far more slowly than the log area.
+
+2 - Function Prototypes (Used in snapshot.c)
+
+snapshot_tick()  ? Called from isr() every 50ms, samples speed and index every SNAP_TICKS
+                   (2 ticks = 100ms, so a window is 2.4 s before and 0.8 s after the trigger).
+snapshot_task()  ? Called once per main loop pass, writes a frozen window to EEPROM.
+*/
@@ -0,0 +1,163 @@
+/*
+ * File:   telemetry.c
+
+ ? Step 43: Setting Up telemetry.c (Live Telemetry Stream)
+This file (telemetry.c) is responsible for:
+? Sampling time, speed and gear at a fixed rate from the Timer0 interrupt.
+? Sending each sample as a CRC-protected frame through the UART TX ring.
+? Dropping samples (with a sequence gap) instead of ever waiting for the UART.
+ */
+
+#include <xc.h>
+#include "main.h"
+#include "telemetry.h"
+
+// Timer0: Fosc/4, prescaler 1:32, reloaded for TM_TICK_HZ
+#define TM_TMR0_COUNTS  (_XTAL_FREQ / 4 / 32 / TM_TICK_HZ)  // 156 at 20MHz
+#define TM_TMR0_RELOAD  (256 - TM_TMR0_COUNTS)
+#define TM_MASK         (TM_RING - 1)
+
+#if TM_TMR0_COUNTS > 256 || TM_TMR0_COUNTS < 32
+#error "TM_TICK_HZ not reachable with Timer0 at this _XTAL_FREQ"
+#endif
+#if (TM_RING & (TM_RING - 1)) != 0
+#error "TM_RING must be a power of 2"
+#endif
+
+typedef struct {
+    unsigned short seq;
+    unsigned char clock[3];     // Hours, minutes, seconds (BCD) from the software clock
+    unsigned char speed;
+    unsigned char event;
+} tm_sample_t;
+
+static tm_sample_t tm_ring[TM_RING];
+static volatile unsigned char tm_head;  // Next sample goes here (ISR)
+static volatile unsigned char tm_tail;  // Next sample to send (main loop)
+static unsigned short tm_period;        // Timer0 ticks per sample
+static unsigned short tm_left;          // Timer0 ticks to the next sample
+static unsigned short tm_seq;           // Sequence number of the next sample
+
+void telemetry_tick(void)
+{
+    unsigned char next;
+
+    TMR0 += TM_TMR0_RELOAD;     // Whole counts of latency kept; the write clears the prescaler (see 1)
+    if (--tm_left)
+        return;
+    tm_left = tm_period;
+
+    next = (tm_head + 1) & TM_MASK;
+    if (next != tm_tail)
+    {
+        tm_sample_t *s = &tm_ring[tm_head];
+
+        s->seq = tm_seq;
+        s->clock[0] = rtc_now.hours & 0x3F;
+        s->clock[1] = rtc_now.minutes;
+        s->clock[2] = rtc_now.seconds & 0x7F;
+        s->speed = speed;
+        s->event = index;
+        tm_head = next;
+    }
+    tm_seq++;                   // A full ring drops the sample, the host sees the gap
+}
+
+static void put_sample(const tm_sample_t *s)
+{
+    unsigned char frame[TM_FRAME_LEN];
+    unsigned long seconds = log_bcd_to_seconds(s->clock[0], s->clock[1], s->clock[2]);
+
+    frame[0] = DL_SOF;
+    frame[1] = TM_FRAME_TELEMETRY;
+    frame[2] = s->seq & 0xFF;
+    frame[3] = TM_PAYLOAD_LEN;
+    frame[4] = s->seq >> 8;
+    frame[5] = seconds >> 16;
+    frame[6] = seconds >> 8;
+    frame[7] = seconds;
+    frame[8] = s->speed;
+    frame[9] = s->event;
+    frame[10] = crc8(CRC8_INIT, frame + 1, TM_FRAME_LEN - 2);
+    uart_write(frame, TM_FRAME_LEN);
+}
+
+void telemetry_task(void)
+{
+    while (tm_tail != tm_head)
+    {
+        if (!download_busy())
+        {
+            if (uart_tx_free() < TM_FRAME_LEN)
+                return;         // Try again next pass, the ISR keeps sampling
+            put_sample(&tm_ring[tm_tail]);
+        }
+        // During a download the sample is dropped, its frames must not be cut
+        tm_tail = (tm_tail + 1) & TM_MASK;
+    }
+}
+
+unsigned char telemetry_start(unsigned char hz)
+{
+    if (hz < TM_RATE_MIN || hz > TM_RATE_MAX)
+        return 0;
+
+    T0IE = 0;
+    tm_period = TM_TICK_HZ / hz;
+    tm_left = tm_period;
+    tm_tail = tm_head;          // Forget samples of an earlier stream
+    tm_seq = 0;
+
+    T0CS = 0;                   // Timer0 clock: Fosc/4
+    PSA = 0;                    // Prescaler on Timer0 ...
+    PS2 = 1;                    // ... 1:32
+    PS1 = 0;
+    PS0 = 0;
+    TMR0 = TM_TMR0_RELOAD;
+    T0IF = 0;
+    T0IE = 1;
+    return 1;
+}
+
+void telemetry_stop(void)
+{
+    T0IE = 0;
+}
+
+/*
+ 1 - telemetry_tick() - Sampling from the ISR
+
+? Timer0 interrupts about every 1 ms while the stream runs. The nominal
+period is 156 counts of 6.4 us at 20MHz = 998.4 us, 0.16 % fast. Adding
+TM_TMR0_RELOAD to TMR0 keeps the whole 6.4 us counts of interrupt latency
+out of the period, but on the PIC16 any write to TMR0 clears the 1:32
+prescaler and holds the count for two cycles. The part of a count already
+in the prescaler (0..31 cycles, depending on the latency) is lost, so each
+period is up to about 6.8 us longer than nominal. The real rate lies
+between 0.16 % fast and about 0.5 % slow. That is fine for a live view:
+every sample carries the software clock time and a sequence number.
+Timer2, the timer with a period register, already drives the LCD writer
+(clcd.c). Every tm_period ticks (1000 / hz) it copies the
+software clock, speed and gear into the sample ring. Sampling runs in the
+ISR, so its jitter is the interrupt latency only, well under one tick,
+whatever the main loop is doing (EEPROM writes, LCD, console commands).
+isr.c checks Timer0 first for the same reason.
+
+? Rates that do not divide 1000 are rounded: 3 Hz samples every 333 ms.
+
+2 - telemetry_task() - Sending from the Main Loop
+
+? Each sample becomes one 11-byte frame (layout in telemetry.h), queued
+with a single uart_write() only when the whole frame fits, so frames are
+never split and the main loop never waits for the UART. The ring holds
+TM_RING samples (80 ms at 50 Hz) for main loop passes that take longer.
+While a download is running the samples are dropped, because telemetry
+frames between download frames would break the ACK/NAK exchange.
+
+? Summary of telemetry.c
+    Function                     Purpose
+telemetry_start(hz)     Sets up Timer0 and starts the stream
+telemetry_stop()        Stops the stream
+telemetry_tick()        Takes a sample every 1000 / hz ms (Timer0 ISR)
+telemetry_task()        Sends sampled frames through the UART TX ring
+ */
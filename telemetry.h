@@ -0,0 +1,71 @@
+/*
+ ? Step 42: Setting Up telemetry.h (Live Telemetry Header File)
+This file (telemetry.h) is needed to:
+? Define the telemetry frame streamed over the UART (shares the download frame layout).
+? Define the rates the stream can run at.
+? Declare the functions called from the main loop, the console and isr.c.
+
+This header does not include <xc.h> so it can also be used by host tools.
+*/
+
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include "download_log.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Telemetry frame
+#define TM_FRAME_TELEMETRY  'T'  // Frame type, see download_log.h for the layout
+#define TM_PAYLOAD_LEN      6    // Sequence number high byte, time (3), speed, event
+#define TM_FRAME_LEN        (DL_FRAME_OVERHEAD + TM_PAYLOAD_LEN)
+
+// Rates
+#define TM_TICK_HZ          1000 // Timer0 sample clock
+#define TM_RATE_MIN         1    // Frames per second
+#define TM_RATE_MAX         50
+#define TM_RING             4    // Samples waiting for the main loop, power of 2
+
+// Function Prototypes
+unsigned char telemetry_start(unsigned char hz);  // Stream at hz frames per second, 0 if out of range
+void telemetry_stop(void);                        // Stop the stream (Timer0 off)
+void telemetry_task(void);                        // Main loop: send sampled frames when the UART has room
+void telemetry_tick(void);                        // Timer0 ISR, every 1 ms while streaming
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
+
+/*
+ 1 - Frame Layout (TM_FRAME_LEN = 11 bytes)
+
+Byte	Content
+0	DL_SOF (0xA5)
+1	TM_FRAME_TELEMETRY ('T')
+2	Sequence number, low byte
+3	Payload length (TM_PAYLOAD_LEN)
+4	Sequence number, high byte
+5..7	Time of the sample, seconds since midnight (most significant byte first)
+8	Speed
+9	Event (gear) index, as in the log
+10	CRC-8 (crc8.h) of bytes 1..9
+
+? Same layout as the download frames, so one host parser handles both. The
+frame number byte is the low half of a 16-bit sequence number that goes up
+by one per sample. A sample that could not be sent (UART busy, download
+running, main loop stalled) is dropped but keeps its number, so the host
+sees every drop as a gap. Telemetry frames are not ACKed.
+
+? At 50 Hz the stream needs 550 bytes/s, a little over half of 9600 baud.
+
+2 - Function Prototypes (Used in telemetry.c)
+
+telemetry_start(hz) ? Starts Timer0 at TM_TICK_HZ and takes a sample every TM_TICK_HZ / hz ticks.
+telemetry_stop()    ? Stops Timer0 and the stream.
+telemetry_task()    ? Builds and queues one frame per sample, never waits for the UART.
+telemetry_tick()    ? Takes the samples, so their timing does not depend on the main loop.
+*/
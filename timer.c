@@ -18,18 +18,22 @@ This file is responsible for:
  * 2 - init_timer1() - Configuring Timer1
  ? This function sets up Timer1 for periodic interrupts:
 
+T1CKPS1 = 1; T1CKPS0 = 0; ? Prescaler 1:4 (TIMER1_PRESCALE, timer.h).
 TMR1ON = 1; ? Turns ON Timer1.
 TMR1IF = 0; ? Clears the Timer1 Interrupt Flag to prevent false triggers.
 TMR1IE = 1; ? Enables interrupts for Timer1 (must also enable GIE and PEIE in main.c).
-TMR1 = 3036; ? Preloads Timer1 with 3036, so it generates an interrupt every 50ms.
+TMR1 = TIMER1_PRELOAD; ? Preloads Timer1 with 3036, so it generates an interrupt every 50ms.
 
 */
 void init_timer1(void) 
 {
-    TMR1ON = 1;   // Turn ON Timer1
+    T1CKPS1 = 1;  // Prescaler 1:4 (reset value is 1:1, which gives 12.5ms)
+    T1CKPS0 = 0;
+    TMR1CS = 0;   // Clock: Fosc/4
+    TMR1 = TIMER1_PRELOAD;  // 62500 counts of 0.8us = 50ms
     TMR1IF = 0;   // Clear Timer1 Interrupt Flag
     TMR1IE = 1;   // Enable Timer1 Interrupt
-    TMR1 = 3036;  // Load Timer1 for a specific delay
+    TMR1ON = 1;   // Turn ON Timer1
 }
 /*
 ? Explanation of timer.c (Timer & Interrupt Handling Code)
@@ -40,12 +44,12 @@ This file is responsible for configuring Timer1 in the PIC16F877A microcontrolle
 
 1?? Understanding Timer1 in PIC16F877A
 ? Timer1 is an internal 16-bit timer in PIC16F877A.
-? It operates using a 4MHz clock frequency (assuming a 20MHz external crystal with a 4:1 division).
+? It counts Fosc/4 = 5MHz (20MHz crystal) through a 1:4 prescaler, 1.25MHz.
 ? Prescaler settings allow us to control the counting speed.
 
 ? Formula to Calculate Timer Delay:
 
- TimerOverflowTime = 4(65536?InitialTimerValue) / Clock Frequency
+ TimerOverflowTime = 4Prescaler(65536?InitialTimerValue) / Clock Frequency
  
-For example, using a 3036 preload value results in 50ms delay per overflow.
+For example, 44(65536 - 3036) / 20MHz = 50ms per overflow (timer.h).
 */
@@ -0,0 +1,49 @@
+/*
+? Step 44: Setting Up timer.h (Timer1 Tick Header File)
+This file (timer.h) is needed to:
+? Define the Timer1 tick that drives timeouts, the software clock and sampling.
+? Derive the prescaler, preload and ticks per second from _XTAL_FREQ.
+? Give every module one tick constant instead of its own hard-coded counts.
+*/
+
+#ifndef TIMER_H
+#define TIMER_H
+
+#ifndef _XTAL_FREQ
+#define _XTAL_FREQ 20000000  // Define for 20MHz Crystal (same as main.h)
+#endif
+
+#define TIMER1_TICK_MS        50   // Timer1 interrupt period
+#define TIMER1_PRESCALE       4    // T1CKPS1:T1CKPS0 = 10
+#define TIMER1_COUNTS         (_XTAL_FREQ / 4 / TIMER1_PRESCALE / 1000 * TIMER1_TICK_MS)  // 62500 at 20MHz
+#define TIMER1_PRELOAD        (65536 - TIMER1_COUNTS)                                     // 3036 at 20MHz
+#define TIMER1_TICKS_PER_SEC  (1000 / TIMER1_TICK_MS)                                     // 20
+
+#if TIMER1_COUNTS > 65536 || TIMER1_COUNTS < 256
+#error "TIMER1_TICK_MS not reachable with Timer1 at this _XTAL_FREQ and prescaler"
+#endif
+#if 1000 % TIMER1_TICK_MS != 0
+#error "TIMER1_TICK_MS must divide one second"
+#endif
+
+// Timer1 ticks in ms milliseconds, rounded up (at least one tick)
+#define TIMER1_TICKS(ms)      (((ms) + TIMER1_TICK_MS - 1) / TIMER1_TICK_MS)
+
+// Function Prototype
+void init_timer1(void);     // Start Timer1 interrupts every TIMER1_TICK_MS
+
+#endif
+
+/*
+ 1 - Timer1 Period
+
+Timer1 counts Fosc/4 through the prescaler:
+
+ Period = 4 * TIMER1_PRESCALE * (65536 - TIMER1_PRELOAD) / _XTAL_FREQ
+        = 4 * 4 * 62500 / 20 MHz = 50 ms
+
+? Without the 1:4 prescaler (T1CON at its reset value, 1:1) the same
+preload gives 12.5 ms, and every count of ticks in the tree would run four
+times fast. Anything that counts Timer1 ticks uses TIMER1_TICKS_PER_SEC or
+TIMER1_TICKS(ms), so changing the tick keeps every timeout in real time.
+*/
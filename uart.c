@@ -16,6 +16,27 @@ This file is responsible for:
 #include "uart.h"
 #include "main.h"
 
+static unsigned char uart_tx_buf[UART_TX_LEN];
+static volatile unsigned char uart_tx_head;     // Next free byte (main loop)
+static volatile unsigned char uart_tx_tail;     // Next byte to send (ISR)
+static unsigned char uart_rx_buf[UART_RX_LEN];
+static volatile unsigned char uart_rx_head;     // Next free byte (ISR)
+static volatile unsigned char uart_rx_tail;     // Next byte to read (main loop)
+
+typedef struct {
+    unsigned long baud;
+    unsigned char spbrg;
+    unsigned char brgh;
+} uart_rate_t;
+
+#define UART_RATE(baud)  { baud, UART_SPBRG(baud), UART_BRGH(baud) }
+
+// Rates uart_set_baud() accepts, each checked against the 2 % limit in uart.h
+static const uart_rate_t uart_rates[] = {
+    UART_RATE(9600UL), UART_RATE(19200UL), UART_RATE(38400UL), UART_RATE(57600UL), UART_RATE(115200UL)
+};
+static unsigned long uart_baud = UART_BAUD;
+
 void init_uart(void) {
     /* Serial initialization */
     RX_PIN = 1;  // Set RX as input
@@ -24,25 +45,92 @@ void init_uart(void) {
     TX9 = 0;     // 8-bit transmission
     TXEN = 1;    // Enable transmitter
     SYNC = 0;    // Set Asynchronous Mode
-    BRGH = 1;    // High Baud Rate Select
+    BRGH = UART_BRGH(UART_BAUD);    // High Baud Rate Select when SPBRG fits
     SPEN = 1;    // Enable Serial Port
 
     RX9 = 0;     // 8-bit reception
     CREN = 1;    // Enable receiver
 
-    SPBRG = 129; // Set Baud Rate to 9600 for 20MHz Clock
+    SPBRG = UART_SPBRG(UART_BAUD);  // 129 for 9600 baud at 20MHz
+    uart_baud = UART_BAUD;
 
-    TXIE = 1;    // Enable TX Interrupt
+    uart_tx_head = uart_tx_tail = 0;
+    uart_rx_head = uart_rx_tail = 0;
+
+    TXIE = 0;    // TX Interrupt, enabled while the TX ring holds data
     TXIF = 0;    // Clear TX Interrupt Flag
     RCIE = 1;    // Enable RX Interrupt
     RCIF = 0;    // Clear RX Interrupt Flag
 }
 
+unsigned char uart_tx_free(void)
+{
+    unsigned char used = uart_tx_head + UART_TX_LEN - uart_tx_tail;
+
+    if (used >= UART_TX_LEN)
+        used -= UART_TX_LEN;
+    return UART_TX_LEN - 1 - used;  // One byte stays empty to tell full from empty
+}
+
+unsigned char uart_write(const unsigned char *buf, unsigned char len)
+{
+    unsigned char head = uart_tx_head;
+    unsigned char n, room = uart_tx_free();
+
+    if (len > room)
+        len = room;
+    for (n = 0; n < len; n++)
+    {
+        uart_tx_buf[head] = buf[n];
+        if (++head == UART_TX_LEN)
+            head = 0;
+    }
+    uart_tx_head = head;  // Bytes are in place before the ISR can see them
+    if (len)
+        TXIE = 1;         // Start (or keep) the transmitter running
+    return len;
+}
+
+#define UART_RATE_NONE  0xFF
+
+// Index of baud in uart_rates[], UART_RATE_NONE if it is not supported
+static unsigned char find_rate(unsigned long baud)
+{
+    for (unsigned char n = 0; n < sizeof uart_rates / sizeof uart_rates[0]; n++)
+    {
+        if (uart_rates[n].baud == baud)
+            return n;
+    }
+    return UART_RATE_NONE;
+}
+
+unsigned char uart_baud_ok(unsigned long baud)
+{
+    return find_rate(baud) != UART_RATE_NONE;
+}
+
+unsigned char uart_set_baud(unsigned long baud)
+{
+    unsigned char n = find_rate(baud);
+
+    if (n == UART_RATE_NONE)
+        return 0;               // Not a supported rate
+    while (uart_tx_head != uart_tx_tail || !TRMT);  // Send what is queued at the old rate
+    BRGH = uart_rates[n].brgh;
+    SPBRG = uart_rates[n].spbrg;
+    uart_baud = baud;
+    return 1;
+}
+
+unsigned long uart_get_baud(void)
+{
+    return uart_baud;
+}
+
 void putch(unsigned char byte) 
 {
     /* Output one byte */
-    while (!TXIF);  // Wait until TX buffer is empty
-    TXREG = byte;   // Load byte into TX register
+    while (!uart_write(&byte, 1));  // Wait only while the TX ring is full
 }
 
 int puts(const char *s) 
@@ -54,11 +142,65 @@ int puts(const char *s)
     return 0;
 }
 
+unsigned char uart_read(unsigned char *byte)
+{
+    unsigned char tail = uart_rx_tail;
+
+    if (tail == uart_rx_head)
+        return 0;               // Nothing received
+    *byte = uart_rx_buf[tail];
+    if (++tail == UART_RX_LEN)
+        tail = 0;
+    uart_rx_tail = tail;
+    return 1;
+}
+
 unsigned char getch(void) 
 {
     /* Retrieve one byte */
-    while (!RCIF);  // Wait until RX buffer is full
-    return RCREG;   // Return received byte
+    unsigned char byte;
+
+    while (!uart_read(&byte));  // Wait until a byte was received
+    return byte;
+}
+
+void uart_isr(void)
+{
+    if (RCIF && RCIE)
+    {
+        unsigned char head = uart_rx_head;
+        unsigned char next = head + 1;
+        unsigned char byte;
+
+        if (OERR)
+        {
+            CREN = 0;           // Overrun stops the receiver, restart it
+            CREN = 1;
+        }
+        byte = RCREG;           // Reading RCREG clears RCIF
+        if (next == UART_RX_LEN)
+            next = 0;
+        if (next != uart_rx_tail)
+        {
+            uart_rx_buf[head] = byte;
+            uart_rx_head = next;
+        }                       // else: RX ring full, byte dropped
+    }
+
+    if (TXIF && TXIE)
+    {
+        unsigned char tail = uart_tx_tail;
+
+        if (tail == uart_tx_head)
+        {
+            TXIE = 0;           // Ring empty; TXIF stays set until TXREG is written
+            return;
+        }
+        TXREG = uart_tx_buf[tail];
+        if (++tail == UART_TX_LEN)
+            tail = 0;
+        uart_tx_tail = tail;
+    }
 }
 
 /*
@@ -120,9 +262,9 @@ This matches the standard 9600 baud rate used for serial communication with a PC
 }
 ? Configures Interrupts for UART Communication:
 
-TXIE = 1; ? Enables Transmit Interrupts (Not used in this code, but ready for future use).
+TXIE = 0; ? Transmit Interrupts stay off until uart_write() puts data in the TX ring.
 TXIF = 0; ? Clears the Transmit Interrupt Flag.
-RCIE = 1; ? Enables Receive Interrupts (Not used in this code, but can be used for receiving commands).
+RCIE = 1; ? Enables Receive Interrupts, uart_isr() moves each byte into the RX ring.
 RCIF = 0; ? Clears the Receive Interrupt Flag.
 2?? putch() - Transmitting a Single Character
 c
@@ -186,10 +328,35 @@ Edit
 char received_char = getch();  // Wait for input from PC
 ? Receives a character from a serial terminal (e.g., PuTTY, Tera Term, Arduino Serial Monitor).
 
+5?? uart_isr() - Interrupt-Driven TX/RX
+
+? putch() no longer waits for TXIF. It calls uart_write(), which copies
+the byte into the TX ring and enables TXIE; putch() only waits when the
+ring is full. The TX interrupt feeds TXREG from the ring one byte at a
+time and turns TXIE off when the ring is empty (TXIF cannot be cleared by
+software, it stays set while TXREG is empty).
+
+? The RX interrupt moves each received byte from RCREG into the RX ring.
+getch() and uart_read() take bytes from the ring, so a byte that arrives
+while the main loop is busy is kept instead of overrunning the UART.
+
+6?? uart_set_baud() - Switching Rate at Run Time
+
+? Looks the rate up in uart_rates[] (SPBRG/BRGH computed at compile time,
+checked for the 2 % limit in uart.h). It waits until the TX ring is empty
+and the last byte has left the shift register (TRMT), so nothing queued
+at the old rate is sent at the new one.
+
 ? Summary of uart.c
 Function	Purpose
-init_uart()	Initializes UART (9600 baud rate, TX/RX setup)
+init_uart()	Initializes UART (UART_BAUD, 9600 by default, TX/RX setup)
+uart_set_baud(baud)	Switches to another supported rate
+uart_baud_ok(baud)	Checks a rate against uart_rates[]
 putch(byte)	Sends a single character via UART
+uart_write(buf, len)	Queues bytes for sending, returns how many fit
+uart_tx_free()	Free space in the TX ring
+uart_read(&byte)	Takes one received byte from the RX ring
+uart_isr()	Moves bytes between the rings and TXREG/RCREG
 puts(s)	Sends a string via UART
 getch()	Receives a character from UART
 */
\ No newline at end of file
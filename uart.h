@@ -9,17 +9,52 @@ The UART Header File (uart.h) is needed to:
 #ifndef UART_H
 #define UART_H
 
+#ifndef _XTAL_FREQ
+#define _XTAL_FREQ 20000000  // Define for 20MHz Crystal (same as main.h)
+#endif
+
+// Baud rate: SPBRG and BRGH are computed by the compiler from _XTAL_FREQ
+#ifndef UART_BAUD
+#define UART_BAUD  9600UL    // Rate after reset (handshake rate)
+#endif
+#define UART_BAUD_ERR_MAX  20   // Largest accepted baud error, in 0.1 % (2 %)
+#define UART_SPBRG_H(baud) ((_XTAL_FREQ + 8 * (baud)) / (16 * (baud)) - 1)   // BRGH = 1, rounded
+#define UART_SPBRG_L(baud) ((_XTAL_FREQ + 32 * (baud)) / (64 * (baud)) - 1)  // BRGH = 0, rounded
+#define UART_BRGH(baud)    (UART_SPBRG_H(baud) <= 255)   // High speed whenever SPBRG fits
+#define UART_SPBRG(baud)   (UART_BRGH(baud) ? UART_SPBRG_H(baud) : UART_SPBRG_L(baud))
+#define UART_REAL(baud)    (_XTAL_FREQ / ((UART_BRGH(baud) ? 16 : 64) * (UART_SPBRG(baud) + 1)))
+#define UART_ERR(baud)     ((UART_REAL(baud) > (baud) ? UART_REAL(baud) - (baud) : (baud) - UART_REAL(baud)) * 1000 / (baud))
+#define UART_BAUD_OK(baud) (UART_SPBRG(baud) <= 255 && UART_ERR(baud) <= UART_BAUD_ERR_MAX)
+
+#if !UART_BAUD_OK(UART_BAUD)
+#error "UART_BAUD is more than 2% off (or out of range) with this _XTAL_FREQ"
+#endif
+#if !UART_BAUD_OK(19200UL) || !UART_BAUD_OK(38400UL) || !UART_BAUD_OK(57600UL) || !UART_BAUD_OK(115200UL)
+#error "A runtime UART baud rate is more than 2% off with this _XTAL_FREQ (see uart_rates[] in uart.c)"
+#endif
+
 // Define UART Pins
 #define RX_PIN  TRISC7  // RX (Receive) on RC7
 #define TX_PIN  TRISC6  // TX (Transmit) on RC6
 
+// Ring buffers (serviced by uart_isr())
+#define UART_TX_LEN  32   // Bytes waiting to be sent
+#define UART_RX_LEN  16   // Bytes received, not yet read
+
 // Function Prototypes
 void init_uart(void);             // Initialize UART
-void putch(unsigned char byte);   // Send one character
+void putch(unsigned char byte);   // Send one character (waits only if the TX ring is full)
 int puts(const char *s);          // Send a string
 unsigned char getch(void);        // Receive one character
 unsigned char getch_with_timeout(unsigned short max_time);
 unsigned char getche(void);
+unsigned char uart_write(const unsigned char *buf, unsigned char len);  // Queue up to len bytes, returns how many fit
+unsigned char uart_tx_free(void); // Free space in the TX ring
+unsigned char uart_read(unsigned char *byte);  // Take one received byte, 0 if none
+void uart_isr(void);              // ISR: move one byte between the rings and TXREG/RCREG
+unsigned char uart_set_baud(unsigned long baud);  // Switch rate once the TX ring has drained, 0 if unsupported
+unsigned char uart_baud_ok(unsigned long baud);   // 1 if uart_set_baud() accepts the rate
+unsigned long uart_get_baud(void);  // Current rate
 
 #endif
 
@@ -58,11 +93,51 @@ puts(s) ? Sends a complete string via UART.
 getch() ? Receives one character via UART.
 getch_with_timeout(max_time) ? Receives a character, but only waits for a limited time.
 getche() ? Receives a character and echoes it back.
+uart_write(buf, len) ? Copies as many bytes as fit into the TX ring and returns that count, never waits.
+uart_tx_free() ? Returns how many bytes uart_write() would accept right now.
+uart_read(&byte) ? Returns 1 and one received byte, or 0 if nothing arrived.
+uart_isr() ? Called from isr.c on RCIF/TXIF.
+uart_set_baud(baud) ? Switches to 9600, 19200, 38400, 57600 or 115200 baud after the pending bytes are sent.
+uart_get_baud() ? Returns the rate in use.
+uart_baud_ok(baud) ? Checks a rate without switching, so a reply can still go out at the old rate.
+
+4 Baud Rate
+
+? The rate after reset is UART_BAUD (9600 unless the build defines it).
+UART_SPBRG(baud) and UART_BRGH(baud) are computed by the compiler from
+_XTAL_FREQ: BRGH = 1 (Fosc / 16) is used whenever SPBRG fits in 8 bits,
+and SPBRG is rounded to the nearest value. UART_ERR() gives the resulting
+error in 0.1 %; a rate more than 2 % off stops the build with #error.
+
+Rate	SPBRG	BRGH	Real rate	Error (20 MHz)
+9600	129	1	9615	0.16 %
+19200	64	1	19231	0.16 %
+38400	32	1	37879	1.36 %
+57600	21	1	56818	1.36 %
+115200	10	1	113636	1.36 %
+
+? uart_set_baud() lets the PC move to a faster rate after connecting at
+UART_BAUD. A full-memory dump of a 24C512 (about 7700 records of ~20 bytes)
+takes about 160 s at 9600 baud and about 14 s at 115200.
+
+5 Ring Buffers
+
+? Bytes to send go into a UART_TX_LEN byte ring. TXIE is switched on
+whenever the ring holds data, and each TX interrupt moves one byte into
+TXREG; when the ring runs empty TXIE is switched off again. Received bytes
+are moved from RCREG into a UART_RX_LEN byte ring by the RX interrupt, so
+none are lost while the main loop is busy (a byte arriving with the ring
+full is dropped, an overrun restarts the receiver).
+
+? At 9600 baud a byte takes about 1 ms on the wire; the main loop only
+pays the few microseconds it takes to copy it into the ring.
  * 
 
 ? Summary of uart.h
     Section                                     Purpose
 Header Guards            ->  Prevents multiple inclusions of the file
 UART Pin Definitions     ->   Assigns RX (RC7) and TX (RC6) pins
+Baud Rate                ->   SPBRG/BRGH from _XTAL_FREQ, 2 % error check
+Ring Buffers             ->   TX/RX rings drained and filled by uart_isr()
 Function Prototypes      ->    Declares UART functions for uart.c
 */
\ No newline at end of file
@@ -0,0 +1,110 @@
+/*
+ * File:   view_log.c
+
+ ? Step 26: Setting Up view_log.c (View Log on LCD)
+This file (view_log.c) is responsible for:
+? Showing the stored event logs on the LCD, one record at a time.
+? Scrolling through the records with the keypad.
+? Returning to the menu when the user is done.
+ */
+
+#include <xc.h>
+#include "main.h"
+#include "clcd.h"
+#include "event_log.h"
+
+void view_log(char key)
+{
+    static unsigned short pos;  // Record shown on LCD (0 = oldest)
+    static log_entry_t entry;   // Decoded record pos, read once
+    static unsigned long seq;   // log_seq(pos) when entry was read
+    static unsigned char cached, valid;
+    unsigned short total = log_count();
+    unsigned char hms[3];
+
+    if (key == MK_SW10)
+    {  // Back to menu
+        pos = 0;
+        cached = 0;
+        main_f = MENU;
+        clcd_clear();
+        return;
+    }
+
+    clcd_print("LOG #", LINE1(0));
+
+    if (total == 0)
+    {
+        pos = 0;
+        cached = 0;
+        clcd_print("NO LOGS         ", LINE2(0));
+        return;
+    }
+
+    if (pos > total - 1)
+        pos = total - 1;           // Log was cleared or shrank while shown
+    if (key == MK_SW11 && pos > 0)
+        pos--;                     // Scroll up
+    else if (key == MK_SW12 && pos < total - 1)
+        pos++;                     // Scroll down
+
+    clcd_putch(pos / 10000 + '0', LINE1(5));
+    clcd_putch(pos / 1000 % 10 + '0', LINE1(6));
+    clcd_putch(pos / 100 % 10 + '0', LINE1(7));
+    clcd_putch(pos / 10 % 10 + '0', LINE1(8));
+    clcd_putch(pos % 10 + '0', LINE1(9));
+
+    // Whole record in one sequential read, only when another record is shown
+    if (!cached || log_seq(pos) != seq)
+    {
+        valid = log_read(pos, &entry);
+        seq = log_seq(pos);
+        cached = 1;
+    }
+    if (!valid)
+    {
+        clcd_print("CRC ERROR       ", LINE2(0));  // Torn or corrupted slot
+        return;
+    }
+    log_seconds_to_hms(entry.seconds, hms);
+
+    clcd_putch(hms[0] / 10 + '0', LINE2(0));
+    clcd_putch(hms[0] % 10 + '0', LINE2(1));
+    clcd_putch(':', LINE2(2));
+    clcd_putch(hms[1] / 10 + '0', LINE2(3));
+    clcd_putch(hms[1] % 10 + '0', LINE2(4));
+    clcd_putch(':', LINE2(5));
+    clcd_putch(hms[2] / 10 + '0', LINE2(6));
+    clcd_putch(hms[2] % 10 + '0', LINE2(7));
+    clcd_putch(' ', LINE2(8));
+    clcd_print(event[entry.event], LINE2(9));
+    clcd_putch(' ', LINE2(11));
+    clcd_putch(entry.speed / 10 + '0', LINE2(12));
+    clcd_putch(entry.speed % 10 + '0', LINE2(13));
+}
+
+/*
+ 1 - view_log() - Show One Record per Screen
+
+? LCD Output Example:
+
+LOG #00007
+12:30:45 G2 40
+
+MK_SW11 ? Scrolls to the previous (older) record.
+MK_SW12 ? Scrolls to the next (newer) record.
+MK_SW10 ? Returns to the menu.
+
+? Records are numbered the same way as in download_log(): 00 is the oldest
+record still stored in the circular log. A slot that fails its CRC check
+shows "CRC ERROR" instead of garbage.
+
+? view_log() runs on every main loop pass. The decoded record is kept in
+RAM with its sequence number (log_seq()), so the EEPROM is read only when
+pos moves or a new record shifts the log under pos, not on every pass.
+pos is clamped to log_count() - 1 so a clear never leaves it past the end.
+
+? Summary of view_log.c
+    Function                         Purpose
+view_log(key)           Displays stored logs on the LCD and handles scrolling
+ */